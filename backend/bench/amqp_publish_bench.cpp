@@ -0,0 +1,69 @@
+// ⏱️ PUBLISH BENCHMARK: confirmed publish per message (one SimpleAmqpClient channel per client) vs AsyncPublisher
+// Needs a local RabbitMQ. Publishes to the "bookings_bench" queue (not "bookings", so
+// booking_consumer doesn't write them); delete it afterwards.
+// Run: ./amqp_publish_bench [clients=64] [seconds=10]
+#include "messaging/AsyncPublisher.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const std::string QUEUE = "bookings_bench";
+
+// Each client behaves like an /api/pay handler: publish, wait for the confirm, next payment.
+// make_pay() runs once on each client thread and returns that client's publish function.
+template <class F>
+static long long paymentsPerSec(int clients, int seconds, F&& make_pay) {
+    std::atomic<bool> stop{false};
+    std::atomic<long long> ok{0};
+    std::vector<std::thread> workers;
+    for (int c = 0; c < clients; c++) {
+        workers.emplace_back([&, c] {
+            auto pay = make_pay();
+            for (int i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                if (pay("BOOK " + std::to_string(i) + " " + std::to_string(c))) ok.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& w : workers) w.join();
+    return ok.load() / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 64;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    try {
+        AmqpClient::Channel::Create()->DeclareQueue(QUEUE, false, true, false, false); // Durable
+    } catch (const std::exception&) { std::cerr << "No broker; start RabbitMQ first\n"; return 1; }
+
+    // SimpleAmqpClient channels are in confirm mode: BasicPublish returns after the broker's ack
+    long long sync = paymentsPerSec(clients, seconds, [] {
+        auto channel = AmqpClient::Channel::Create();
+        return [channel](const std::string& body) {
+            auto message = AmqpClient::BasicMessage::Create(body);
+            message->DeliveryMode(AmqpClient::BasicMessage::dm_persistent);
+            try { channel->BasicPublish("", QUEUE, message, true); return true; }
+            catch (const std::exception&) { return false; }
+        };
+    });
+
+    auto* async = new AsyncPublisher(QUEUE); // Its thread runs until exit, like the server's
+    while (!async->connected()) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    long long batched = paymentsPerSec(clients, seconds, [async] {
+        return [async](const std::string& body) { return async->publish(body).get(); };
+    });
+
+    auto* batch = Metrics::GetInstance()->histogram("amqp.async.batch_size");
+    auto* confirm = Metrics::GetInstance()->histogram("amqp.async.confirm_us");
+    std::cout << "📮 " << clients << " clients, " << seconds << "s each\n";
+    std::cout << "   confirm per message : " << sync << " payments/sec\n";
+    std::cout << "   async + window      : " << batched << " payments/sec (batch p50 " << batch->percentile(0.5)
+              << ", confirm p99 " << confirm->percentile(0.99) << "us)\n";
+    return 0;
+}
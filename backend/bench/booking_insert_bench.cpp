@@ -0,0 +1,59 @@
+// ⏱️ BOOKING INSERT BENCHMARK: per-seat loop vs one unnest() statement vs COPY
+// Needs the local Postgres from setup_db.py. Every transaction is rolled back, so no rows are left behind.
+// Run: ./booking_insert_bench [iterations=200]
+#include "db.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+template <class F>
+static double usPerBooking(pqxx::connection& conn, int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        pqxx::work txn(conn);
+        body(txn);
+        txn.abort();
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)us / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+
+    // One MASTER connection for the whole run; the old per-seat statement is prepared just for the baseline
+    DBConnection conn(PoolType::MASTER);
+    conn->prepare("bench_seat_insert", "INSERT INTO booking_seats (booking_id, screen_seat_id) VALUES ($1, $2)");
+    std::vector<int> all_seats;
+    {
+        pqxx::work txn(*conn);
+        for (auto row : txn.exec_prepared(Statements::SEAT_IDS)) all_seats.push_back(row[0].as<int>());
+    }
+
+    const std::optional<std::string> no_key; // NULL idempotency key: always a fresh booking
+    std::cout << "🎟️ " << iterations << " bookings per case (us per booking)\n";
+    for (size_t n : {1, 10, 100}) {
+        if (all_seats.size() < n) break;
+        std::vector<int> seats(all_seats.begin(), all_seats.begin() + n);
+
+        double loop = usPerBooking(*conn, iterations, [&](pqxx::work& txn) {
+            int id = txn.exec_prepared(Statements::BOOKING_INSERT, 1, 1, 250.0, no_key)[0][0].as<int>();
+            for (int seat : seats) txn.exec_prepared("bench_seat_insert", id, seat);
+        });
+        double set = usPerBooking(*conn, iterations, [&](pqxx::work& txn) {
+            txn.exec_prepared(Statements::BOOKING_WITH_SEATS, 1, 1, 250.0, Statements::intArray(seats), no_key);
+        });
+        double copy = usPerBooking(*conn, iterations, [&](pqxx::work& txn) {
+            int id = txn.exec_prepared(Statements::BOOKING_INSERT, 1, 1, 250.0, no_key)[0][0].as<int>();
+            auto stream = pqxx::stream_to::table(txn, {"booking_seats"}, {"booking_id", "screen_seat_id"});
+            for (int seat : seats) stream.write_values(id, seat);
+            stream.complete();
+        });
+
+        std::cout << "   " << n << " seats : loop " << loop << " | unnest " << set << " | copy " << copy << "\n";
+    }
+    return 0;
+}
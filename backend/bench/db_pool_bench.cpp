@@ -0,0 +1,60 @@
+// ⏱️ CONTENTION BENCHMARK: 64 threads hammering the DB pool
+// Needs the local Postgres from setup_db.py.
+// Run: ./db_pool_bench [threads=64] [seconds=10] [query=0|1]
+//   query=0 measures the pool alone (borrow + return), query=1 adds a "SELECT 1" per borrow.
+#include "db.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 64;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+    bool query = argc > 3 && std::atoi(argv[3]) != 0;
+
+    DBPool::GetInstance(); // Open connections before the clock starts
+    std::atomic<bool> stop{false};
+    std::atomic<long long> ops{0}, busy{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        // Every 4th thread writes, like the real mix of reads and bookings
+        PoolType type = t % 4 == 0 ? PoolType::MASTER : PoolType::REPLICA;
+        workers.emplace_back([&, type] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                try {
+                    DBConnection conn(type);
+                    if (query) {
+                        pqxx::nontransaction txn(*conn);
+                        txn.exec("SELECT 1");
+                    }
+                    ops.fetch_add(1, std::memory_order_relaxed);
+                } catch (const PoolTimeoutError&) {
+                    busy.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& w : workers) w.join();
+
+    auto* metrics = Metrics::GetInstance();
+    std::cout << "🏊 " << threads << " threads, " << seconds << "s, query=" << query << "\n";
+    std::cout << "   borrows/sec : " << ops.load() / seconds << "\n";
+    std::cout << "   timeouts    : " << busy.load() << "\n";
+    auto* db = DBPool::GetInstance();
+    std::vector<std::string> pools = {db->master().name()};
+    for (size_t i = 0; i < db->replicas().size(); i++) pools.push_back(db->replicas().replica(i).name());
+    for (const auto& pool : pools) {
+        auto* h = metrics->histogram("db." + pool + ".acquire_wait_us");
+        std::cout << "   " << pool << " wait us : p50 " << h->percentile(0.5) << " | p99 " << h->percentile(0.99)
+                  << " | n " << h->count() << "\n";
+    }
+    return 0;
+}
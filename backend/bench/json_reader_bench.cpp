@@ -0,0 +1,69 @@
+// ⏱️ MICROBENCHMARK: /api/pay body parsing (crow::json::load DOM vs JsonReader on-demand)
+// Bodies:
+//   valid     : {"show_id": 12, "seat_ids": [...]} with N seats
+//   padded    : the same body with a long "note" string the route ignores
+//   malformed : a valid prefix cut off mid-array (what a flood of junk looks like)
+// Build: cmake -DBUILD_BENCHMARKS=ON ..   Run: ./json_reader_bench [seats=6]
+#include "crow/json.h"
+#include "codec/JsonReader.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+template <class F>
+static double nsPerOp(int iterations, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) f();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)ns / iterations;
+}
+
+// What /api/pay used to do
+static size_t viaDom(const std::string& body) {
+    auto x = crow::json::load(body);
+    if (!x) return 0;
+    size_t n = x.has("show_id") ? (size_t)x["show_id"].i() : 0;
+    if (x.has("seat_ids")) for (const auto& s : x["seat_ids"]) n += (size_t)s.i();
+    return n;
+}
+
+// What it does now
+static size_t viaReader(const std::string& body) {
+    int show_id = 0;
+    std::vector<int> seats;
+    bool ok = JsonReader::forEachField(body, [&](std::string_view key, JsonReader::Value& v) {
+        if (key == "show_id") return v.asInt(show_id);
+        if (key == "seat_ids") return v.asIntArray(seats, 50);
+        return true;
+    });
+    if (!ok) return 0;
+    size_t n = (size_t)show_id;
+    for (int s : seats) n += (size_t)s;
+    return n;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 6;
+    const int iterations = 200000;
+
+    std::string seats;
+    for (int i = 0; i < n; i++) seats += (i ? ", " : "") + std::to_string(1000 + i);
+    std::string valid = "{\"show_id\": 12, \"seat_ids\": [" + seats + "]}";
+    std::string padded = "{\"note\": \"" + std::string(2000, 'x') + "\", \"show_id\": 12, \"seat_ids\": [" + seats + "]}";
+    std::string malformed = valid.substr(0, valid.size() - 4);
+
+    struct Case { const char* name; const std::string* body; };
+    Case cases[] = {{"valid     : ", &valid}, {"padded    : ", &padded}, {"malformed : ", &malformed}};
+
+    size_t sink = 0;
+    std::cout << "🔎 " << n << " seats per body, " << iterations << " iterations\n";
+    for (const auto& c : cases) {
+        double dom = nsPerOp(iterations, [&] { sink += viaDom(*c.body); });
+        double reader = nsPerOp(iterations, [&] { sink += viaReader(*c.body); });
+        std::cout << "   " << c.name << c.body->size() << " bytes | crow::json " << dom << " ns | JsonReader " << reader << " ns\n";
+    }
+    std::cout << "   (sink " << sink << ")\n";
+    return 0;
+}
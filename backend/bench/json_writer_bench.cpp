@@ -0,0 +1,118 @@
+// ⏱️ MICROBENCHMARK: response serialization (stringstream vs crow::json::wvalue vs JsonWriter)
+// Two payloads shaped like the hot responses:
+//   seat map   : /api/seats, one screen's seats {id, label, status}
+//   bookings   : /api/my-bookings page {id, amount, status}
+// Reports ns per document and heap allocations per document (global operator new is counted).
+// Build: cmake -DBUILD_BENCHMARKS=ON ..   Run: ./json_writer_bench [seats=500] [bookings=50]
+#include "crow/json.h"
+#include "codec/JsonWriter.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::atomic<long long> allocations{0};
+
+void* operator new(size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+struct SeatRow { int id; std::string label; std::string status; };
+struct BookingRow { int id; double amount; std::string status; };
+
+struct Result { double ns; double allocs; size_t bytes; };
+
+template <class F>
+static Result measure(int iterations, F&& f) {
+    size_t bytes = f(); // Warm-up (also lets the thread buffer reach its working size)
+    long long before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) bytes = f();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return {(double)ns / iterations, (double)(allocations.load() - before) / iterations, bytes};
+}
+
+static void report(const char* name, const Result& r) {
+    std::cout << "   " << name << r.bytes << " bytes | " << r.ns << " ns | " << r.allocs << " allocs\n";
+}
+
+int main(int argc, char* argv[]) {
+    int n_seats = argc > 1 ? std::atoi(argv[1]) : 500;
+    int n_bookings = argc > 2 ? std::atoi(argv[2]) : 50;
+    const int iterations = 20000;
+
+    std::vector<SeatRow> seats;
+    for (int i = 0; i < n_seats; i++) {
+        seats.push_back({i + 1, std::string(1, (char)('A' + i / 20 % 26)) + std::to_string(1 + i % 20), i % 7 == 0 ? "BOOKED" : "AVAILABLE"});
+    }
+    std::vector<BookingRow> bookings;
+    for (int i = 0; i < n_bookings; i++) bookings.push_back({100000 - i, 50.0 * (1 + i % 4), i % 9 == 0 ? "FAILED" : "CONFIRMED"});
+
+    // ------------------------------------------------------------------ seat map
+    std::cout << "💺 seat map, " << n_seats << " seats, " << iterations << " iterations\n";
+    report("stringstream : ", measure(iterations, [&] {
+        std::stringstream json; json << "[";
+        for (size_t i = 0; i < seats.size(); ++i) {
+            json << "{\"id\": " << seats[i].id << ", \"label\": \"" << seats[i].label << "\", \"status\": \"" << seats[i].status << "\"}";
+            if (i < seats.size() - 1) json << ",";
+        }
+        json << "]";
+        return json.str().size();
+    }));
+    report("wvalue       : ", measure(iterations, [&] {
+        crow::json::wvalue arr;
+        for (size_t i = 0; i < seats.size(); i++) {
+            arr[(unsigned)i]["id"] = seats[i].id;
+            arr[(unsigned)i]["label"] = seats[i].label;
+            arr[(unsigned)i]["status"] = seats[i].status;
+        }
+        return arr.dump().size();
+    }));
+    report("JsonWriter   : ", measure(iterations, [&] {
+        std::string& body = JsonWriter::threadBuffer();
+        JsonWriter json(body);
+        json.beginArray();
+        for (const auto& s : seats) json.beginObject().field("id", s.id).field("label", s.label).field("status", s.status).endObject();
+        json.endArray();
+        return body.size();
+    }));
+
+    // ------------------------------------------------------------------ bookings page
+    std::cout << "🧾 bookings page, " << n_bookings << " rows, " << iterations << " iterations\n";
+    report("stringstream : ", measure(iterations, [&] {
+        std::stringstream json; json << "[";
+        for (size_t i = 0; i < bookings.size(); ++i) {
+            json << "{\"id\": " << bookings[i].id << ", \"amount\": " << bookings[i].amount << ", \"status\": \"" << bookings[i].status << "\"}";
+            if (i < bookings.size() - 1) json << ",";
+        }
+        json << "]";
+        return json.str().size();
+    }));
+    report("wvalue       : ", measure(iterations, [&] {
+        crow::json::wvalue arr;
+        for (size_t i = 0; i < bookings.size(); i++) {
+            arr[(unsigned)i]["id"] = bookings[i].id;
+            arr[(unsigned)i]["amount"] = bookings[i].amount;
+            arr[(unsigned)i]["status"] = bookings[i].status;
+        }
+        return arr.dump().size();
+    }));
+    report("JsonWriter   : ", measure(iterations, [&] {
+        std::string& body = JsonWriter::threadBuffer();
+        JsonWriter json(body);
+        json.beginArray();
+        for (const auto& b : bookings) json.beginObject().field("id", b.id).field("amount", b.amount).field("status", b.status).endObject();
+        json.endArray();
+        return body.size();
+    }));
+    std::cout << "   (JsonWriter figures exclude the one copy into crow::response)\n";
+    return 0;
+}
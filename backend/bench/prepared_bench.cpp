@@ -0,0 +1,73 @@
+// ⏱️ PGBENCH-STYLE COMPARISON: exec_params (parse + plan every call) vs exec_prepared (plan once)
+// Needs the local Postgres from setup_db.py.
+// Run: ./prepared_bench [clients=8] [seconds=10]
+//   Each client loops the catalog join + seat map, like the hottest read path.
+#include "db.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct RunResult {
+    long long transactions;
+    double avg_latency_ms;
+};
+
+template <class F>
+static RunResult run(int clients, int seconds, F&& body) {
+    std::atomic<bool> stop{false};
+    std::atomic<long long> txns{0}, total_us{0};
+
+    std::vector<std::thread> workers;
+    for (int c = 0; c < clients; c++) {
+        workers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto start = std::chrono::steady_clock::now();
+                DBConnection conn(PoolType::REPLICA);
+                pqxx::nontransaction txn(*conn);
+                body(txn);
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                txns.fetch_add(1, std::memory_order_relaxed);
+                total_us.fetch_add(us, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& w : workers) w.join();
+    long long n = txns.load();
+    return {n, n ? total_us.load() / 1000.0 / n : 0.0};
+}
+
+int main(int argc, char* argv[]) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 8;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    DBPool::GetInstance(); // Connections (and their prepared statements) exist before the clock starts
+    const char* catalog_sql = nullptr;
+    const char* seat_sql = nullptr;
+    for (const auto& s : Statements::all()) {
+        if (std::string(s.name) == Statements::CATALOG_SHOWS) catalog_sql = s.sql;
+        if (std::string(s.name) == Statements::SEAT_MAP) seat_sql = s.sql;
+    }
+
+    RunResult unprepared = run(clients, seconds, [&](pqxx::nontransaction& txn) {
+        txn.exec_params(catalog_sql, 1);
+        txn.exec_params(seat_sql, 1);
+    });
+    RunResult prepared = run(clients, seconds, [](pqxx::nontransaction& txn) {
+        txn.exec_prepared(Statements::CATALOG_SHOWS, 1);
+        txn.exec_prepared(Statements::SEAT_MAP, 1);
+    });
+
+    std::cout << "📜 " << clients << " clients, " << seconds << "s each\n";
+    std::cout << "   exec_params   : tps " << unprepared.transactions / seconds
+              << " | latency avg " << unprepared.avg_latency_ms << " ms\n";
+    std::cout << "   exec_prepared : tps " << prepared.transactions / seconds
+              << " | latency avg " << prepared.avg_latency_ms << " ms\n";
+    return 0;
+}
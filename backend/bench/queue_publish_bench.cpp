@@ -0,0 +1,98 @@
+// ⏱️ BOOKING QUEUE BENCHMARK: RabbitMQ (AsyncPublisher) vs the embedded log (MmapLog)
+// Same shape as the outbox relay's use: publish, wait until the transport says it's safe.
+// The broker run needs a local RabbitMQ and publishes to "bookings_bench" (delete it
+// afterwards); it is skipped if no broker answers. The log run writes to a scratch
+// directory under the temp dir, which is removed at the end.
+// Run: ./queue_publish_bench [clients=64] [seconds=10]
+#include "messaging/AsyncPublisher.h"
+#include "messaging/MmapLog.h"
+#include "codec/BookingEvent.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const std::string QUEUE = "bookings_bench";
+
+struct Result {
+    long long per_sec = 0;
+    long long p50_us = 0;
+    long long p99_us = 0;
+};
+
+// Each client publishes a realistic BookingEvent and waits for its confirm before the next
+static Result run(BookingQueue& queue, int clients, int seconds) {
+    std::atomic<bool> stop{false};
+    std::atomic<long long> ok{0};
+    std::mutex samples_mutex;
+    std::vector<long long> samples;
+    std::vector<std::thread> workers;
+    for (int c = 0; c < clients; c++) {
+        workers.emplace_back([&, c] {
+            BookingEvent::Event e;
+            e.user_id = c + 1;
+            e.show_id = 1;
+            e.seat_ids = {1, 2};
+            e.amount_cents = 10000;
+            e.idempotency_key = "bench-" + std::to_string(c);
+            std::vector<long long> mine;
+            for (int i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                e.created_ms = i;
+                auto start = std::chrono::steady_clock::now();
+                if (!queue.publish(BookingEvent::encode(e)).get()) continue;
+                mine.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+                ok.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::lock_guard<std::mutex> lock(samples_mutex);
+            samples.insert(samples.end(), mine.begin(), mine.end());
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& w : workers) w.join();
+
+    Result r;
+    r.per_sec = ok.load() / seconds;
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+        r.p50_us = samples[samples.size() / 2];
+        r.p99_us = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    }
+    return r;
+}
+
+static void report(const char* name, const Result& r) {
+    std::cout << "   " << name << r.per_sec << " publishes/sec (p50 " << r.p50_us << "us, p99 " << r.p99_us << "us)\n";
+}
+
+int main(int argc, char* argv[]) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 64;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+    std::cout << "📮 " << clients << " clients, " << seconds << "s each\n";
+
+    // Both transports run detached threads until exit, like the server's, so neither is freed
+    auto* amqp = new AsyncPublisher(QUEUE);
+    for (int i = 0; i < 40 && !amqp->connected(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (amqp->connected()) report("rabbitmq (confirms) : ", run(*amqp, clients, seconds));
+    else std::cout << "   rabbitmq (confirms) : skipped, no broker\n";
+
+    LogFormat::Options opts = LogFormat::Options::fromEnv();
+    opts.dir = std::filesystem::temp_directory_path() / ("tm_queue_bench_" + std::to_string(std::time(nullptr)));
+    auto* log = new MmapLog(opts);
+    report("mmap log (fsync)    : ", run(*log, clients, seconds));
+
+    auto* batch = Metrics::GetInstance()->histogram("log.fsync_batch");
+    auto* fsync = Metrics::GetInstance()->histogram("log.fsync_us");
+    std::cout << "   log fsync batch p50 " << batch->percentile(0.5) << ", fsync p99 " << fsync->percentile(0.99) << "us\n";
+
+    std::error_code ec;
+    std::filesystem::remove_all(opts.dir, ec);
+    return 0;
+}
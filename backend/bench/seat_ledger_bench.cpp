@@ -0,0 +1,82 @@
+// ⏱️ SEAT LEDGER RECOVERY BENCHMARK
+// Records N seat events (random lifecycles over a fixed seat pool), snapshots at 90%, then
+// measures how long a fresh ledger takes to come back:
+//   snapshot + tail : load snapshot.bin, replay the last 10% of the log
+//   full replay     : no snapshot, replay every event
+// Works in a scratch directory under the temp dir, removed at the end.
+// Run: ./seat_ledger_bench [events=10000000] [seats=1000000]
+#include "ledger/SeatLedger.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+static long long msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, SeatLedger& ledger, long long total_ms, size_t expected_seats) {
+    const auto& r = ledger.recovery();
+    std::cout << "   " << name << total_ms << "ms total (snapshot " << r.snapshot_seats << " seats in " << r.snapshot_ms
+              << "ms, " << r.replayed << " events replayed in " << r.replay_ms << "ms) -> " << ledger.size() << " seats"
+              << (ledger.size() == expected_seats ? "" : " ❌ MISMATCH") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    int seats = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    const int SEATS_PER_SHOW = 500;
+
+    SeatLedger::Options opts;
+    opts.dir = std::filesystem::temp_directory_path() / ("tm_ledger_bench_" + std::to_string(std::time(nullptr)));
+    opts.snapshot_every = 0; // Snapshot exactly where the bench says
+
+    // Every ledger owns an MmapLog whose flusher runs until exit, so none of them is freed
+    auto* writer = new SeatLedger(opts);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick_seat(0, seats - 1);
+    std::uniform_int_distribution<int> pick_type(0, 99);
+    int64_t far_future = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             (std::chrono::system_clock::now() + std::chrono::hours(24)).time_since_epoch()).count();
+
+    auto start = std::chrono::steady_clock::now();
+    long long snapshot_ms = 0;
+    for (size_t i = 0; i < events; i++) {
+        int seat = pick_seat(rng);
+        int roll = pick_type(rng);
+        SeatEvent::Type type = roll < 50 ? SeatEvent::Type::RESERVED
+                             : roll < 65 ? SeatEvent::Type::PAID
+                             : roll < 75 ? SeatEvent::Type::CONFIRMED
+                             : roll < 95 ? SeatEvent::Type::EXPIRED
+                                         : SeatEvent::Type::RELEASED;
+        writer->record(type, 1 + seat / SEATS_PER_SHOW, seat, type == SeatEvent::Type::CONFIRMED ? 0 : far_future);
+        if (i + 1 == events * 9 / 10) {
+            auto snap = std::chrono::steady_clock::now();
+            writer->snapshot();
+            snapshot_ms = msSince(snap);
+        }
+    }
+    writer->sync();
+    long long write_ms = std::max(1LL, msSince(start));
+    size_t expected = writer->size();
+
+    std::cout << "📒 " << events << " events over " << seats << " seats\n";
+    std::cout << "   record              : " << write_ms << "ms (" << (long long)(events * 1000 / write_ms) << " events/sec), snapshot "
+              << snapshot_ms << "ms\n";
+
+    start = std::chrono::steady_clock::now();
+    auto* from_snapshot = new SeatLedger(opts);
+    report("snapshot + tail     : ", *from_snapshot, msSince(start), expected);
+
+    std::filesystem::remove(opts.dir / "snapshot.bin");
+    start = std::chrono::steady_clock::now();
+    auto* full = new SeatLedger(opts);
+    report("full replay         : ", *full, msSince(start), expected);
+
+    std::error_code ec;
+    std::filesystem::remove_all(opts.dir, ec);
+    return 0;
+}
@@ -0,0 +1,61 @@
+// ⏱️ MICROBENCHMARK: ShowCodec (binary) vs JSON for a theater's show listing
+// Build: cmake -DBUILD_BENCHMARKS=ON ..   Run: ./show_codec_bench [shows_per_listing]
+#include "crow/json.h"
+#include "codec/ShowCodec.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static std::vector<Show> makeShows(int n) {
+    const char* titles[] = {"Avengers", "Oppenheimer", "Dune: Part Two", "Interstellar", "Inception"};
+    std::vector<Show> shows;
+    for (int i = 0; i < n; i++) {
+        shows.push_back({i + 1, titles[i % 5], "2025-10-10 " + std::to_string(10 + i % 12) + ":00:00", 200.0 + (i % 4) * 50});
+    }
+    return shows;
+}
+
+template <class F>
+static double nsPerOp(int iterations, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) f();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)ns / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 50;
+    const int iterations = 20000;
+    std::vector<Show> shows = makeShows(n);
+    size_t sink = 0;
+
+    // --- JSON (what the cache used to hold; JsonWriter out, crow::json in) ---
+    std::string json = Show::toJsonArray(shows);
+    double json_encode = nsPerOp(iterations, [&] { sink += Show::toJsonArray(shows).size(); });
+    double json_decode = nsPerOp(iterations, [&] {
+        auto doc = crow::json::load(json);
+        std::vector<Show> out;
+        out.reserve(doc.size());
+        for (size_t i = 0; i < doc.size(); i++) {
+            out.push_back({(int)doc[i]["id"].i(), doc[i]["movie"].s(), doc[i]["time"].s(), doc[i]["price"].d()});
+        }
+        sink += out.size();
+    });
+
+    // --- ShowCodec (what the cache holds now) ---
+    std::string binary = ShowCodec::encode(shows);
+    double bin_encode = nsPerOp(iterations, [&] { sink += ShowCodec::encode(shows).size(); });
+    std::vector<Show> decoded;
+    double bin_decode = nsPerOp(iterations, [&] {
+        ShowCodec::decode(binary, decoded);
+        sink += decoded.size();
+    });
+
+    std::cout << "📦 " << n << " shows per listing, " << iterations << " iterations\n";
+    std::cout << "   JSON       : " << json.size() << " bytes | encode " << json_encode << " ns | decode " << json_decode << " ns\n";
+    std::cout << "   ShowCodec  : " << binary.size() << " bytes | encode " << bin_encode << " ns | decode " << bin_decode << " ns\n";
+    std::cout << "   (sink " << sink << ")\n";
+    return 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <zlib.h>
+#ifdef TM_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+// 🗜️ ONE-SHOT COMPRESSORS
+// Only ever called when a cache entry is (re)built, never per request.
+// Both return an empty string on failure so callers fall back to identity.
+namespace Compression {
+
+    inline std::string gzip(const std::string& input, int level = Z_BEST_COMPRESSION) {
+        z_stream zs{};
+        // windowBits 15 + 16 = gzip wrapper instead of raw zlib
+        if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return "";
+
+        std::string out;
+        out.resize(deflateBound(&zs, (uLong)input.size()));
+        zs.next_in = (Bytef*)input.data();
+        zs.avail_in = (uInt)input.size();
+        zs.next_out = (Bytef*)&out[0];
+        zs.avail_out = (uInt)out.size();
+
+        int rc = deflate(&zs, Z_FINISH);
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return rc == Z_STREAM_END ? out : "";
+    }
+
+    inline bool brotliAvailable() {
+#ifdef TM_HAVE_BROTLI
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline std::string brotli(const std::string& input) {
+#ifdef TM_HAVE_BROTLI
+        size_t out_size = BrotliEncoderMaxCompressedSize(input.size());
+        if (out_size == 0) return "";
+        std::string out(out_size, '\0');
+        if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                                   input.size(), (const uint8_t*)input.data(),
+                                   &out_size, (uint8_t*)&out[0])) return "";
+        out.resize(out_size);
+        return out;
+#else
+        (void)input;
+        return "";
+#endif
+    }
+}
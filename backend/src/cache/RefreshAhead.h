@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+// ⏩ REFRESH-AHEAD (XFetch / Probabilistic Early Expiration)
+// Every reader rolls the dice:  refresh early if  delta * beta * -ln(rand) >= remaining_ttl
+//   delta = how long the last recompute took (ms), stored next to the value
+//   beta  = eagerness (> 1 refreshes earlier, < 1 later)
+// A hot key gets read many times near its expiry, so one of those reads almost
+// certainly wins the roll and refreshes it in the background before the TTL hits.
+// A cold key is rarely read, never wins, and simply lapses. No synchronized miss spike.
+class RefreshAhead {
+private:
+    static RefreshAhead* instance;
+    static std::mutex instance_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::pair<std::string, std::function<void()>>> queue_;
+    std::unordered_set<std::string> in_flight_; // One refresh per key at a time
+    std::thread worker_;
+
+    RefreshAhead() {
+        worker_ = std::thread([this] { run(); });
+        worker_.detach();
+    }
+
+    void run() {
+        while (true) {
+            std::pair<std::string, std::function<void()>> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !queue_.empty(); });
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            try { job.second(); }
+            catch (const std::exception& e) { std::cerr << "⚠️ Refresh-ahead failed for " << job.first << ": " << e.what() << std::endl; }
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.erase(job.first);
+        }
+    }
+
+public:
+    static RefreshAhead* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new RefreshAhead();
+        return instance;
+    }
+
+    // 🎲 The XFetch roll. Pure function, no locks.
+    static bool shouldRefreshEarly(double delta_ms, long long ttl_remaining_ms, double beta = 1.0) {
+        if (ttl_remaining_ms < 0) return false; // -1 = no TTL, -2 = gone (normal miss path handles it)
+        if (delta_ms <= 0) return false;        // No recorded cost yet
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        std::uniform_real_distribution<double> dist(std::nextafter(0.0, 1.0), 1.0);
+        return delta_ms * beta * -std::log(dist(rng)) >= (double)ttl_remaining_ms;
+    }
+
+    // Queue a background recompute. Returns false if one is already pending for this key.
+    bool schedule(const std::string& key, std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!in_flight_.insert(key).second) return false;
+            queue_.emplace_back(key, std::move(task));
+        }
+        cv_.notify_one();
+        return true;
+    }
+};
+
+RefreshAhead* RefreshAhead::instance = nullptr;
+std::mutex RefreshAhead::instance_mutex_;
@@ -0,0 +1,199 @@
+#pragma once
+#include "Compression.h"
+#include "crow.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 🏷️ IN-PROCESS RESPONSE CACHE (ETag + Precompressed Variants)
+// Sits in front of Redis/Postgres for hot GET responses:
+//   - A valid entry answers If-None-Match with 304 without touching Redis or the DB
+//   - gzip/brotli variants are built ONCE when the content changes, never per request
+// Entries are short-lived on purpose; Redis stays the cross-node source of truth.
+// Expired entries are purged every PURGE_EVERY puts, and past MAX_ENTRIES the ones closest
+// to expiry are evicted, so keys that are never asked for again don't pile up.
+// An entry built from a refresh-ahead key also remembers that key's recompute cost and
+// Redis expiry, so local hits can keep rolling the XFetch dice (see RefreshAhead.h).
+struct CachedResponse {
+    std::string etag;     // Strong ETag, quoted: "9f86d081884c7d65"
+    std::string identity; // Uncompressed body
+    std::string gzip;     // Empty if compression failed or didn't help
+    std::string br;       // Empty if brotli isn't built in
+    std::string content_type;
+    std::chrono::steady_clock::time_point expires_at;
+    double delta_ms = 0;                                        // Source's last recompute time, 0 = unknown
+    std::chrono::steady_clock::time_point source_expires_at{}; // When the Redis copy expires
+};
+
+class ResponseCache {
+public:
+    static constexpr size_t MAX_ENTRIES = 4096;
+    static constexpr size_t PURGE_EVERY = 256;
+
+private:
+    static ResponseCache* instance;
+    static std::mutex instance_mutex_;
+
+    std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const CachedResponse>> entries_;
+    size_t puts_since_purge_ = 0;
+
+    ResponseCache() {}
+
+    // 🧹 Caller holds the unique lock. Drops expired entries; if still over the cap, evicts the
+    // soonest-to-expire down to 90% of MAX_ENTRIES so the next few inserts don't rescan.
+    void purge(std::chrono::steady_clock::time_point now) {
+        puts_since_purge_ = 0;
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->second->expires_at <= now) it = entries_.erase(it);
+            else ++it;
+        }
+        if (entries_.size() <= MAX_ENTRIES) return;
+
+        std::vector<std::pair<std::chrono::steady_clock::time_point, std::string>> by_expiry;
+        by_expiry.reserve(entries_.size());
+        for (const auto& [key, entry] : entries_) by_expiry.emplace_back(entry->expires_at, key);
+        size_t evict = entries_.size() - MAX_ENTRIES * 9 / 10;
+        std::nth_element(by_expiry.begin(), by_expiry.begin() + evict, by_expiry.end());
+        for (size_t i = 0; i < evict; i++) entries_.erase(by_expiry[i].second);
+    }
+
+    // 🧮 FNV-1a over the body: same bytes -> same ETag on every node
+    static std::string strongEtag(const std::string& body) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : body) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        char buf[24];
+        std::snprintf(buf, sizeof(buf), "\"%016llx\"", (unsigned long long)hash);
+        return buf;
+    }
+
+    // Does a comma separated header list contain this token (with q != 0)?
+    static bool acceptsEncoding(const std::string& header, const std::string& coding) {
+        size_t pos = 0;
+        while (pos < header.size()) {
+            size_t end = header.find(',', pos);
+            if (end == std::string::npos) end = header.size();
+            std::string item = header.substr(pos, end - pos);
+            pos = end + 1;
+
+            size_t first = item.find_first_not_of(' ');
+            if (first == std::string::npos) continue;
+            size_t semi = item.find(';');
+            std::string name = item.substr(first, semi == std::string::npos ? std::string::npos : semi - first);
+            while (!name.empty() && name.back() == ' ') name.pop_back();
+            if (name != coding && name != "*") continue;
+            size_t q = semi == std::string::npos ? std::string::npos : item.find("q=", semi);
+            if (q != std::string::npos && std::atof(item.c_str() + q + 2) <= 0.0) continue; // q=0 means "never"
+            return true;
+        }
+        return false;
+    }
+
+public:
+    static ResponseCache* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new ResponseCache();
+        return instance;
+    }
+
+    // Returns the entry only while it is still fresh
+    std::shared_ptr<const CachedResponse> get(const std::string& key) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || it->second->expires_at <= std::chrono::steady_clock::now()) return nullptr;
+        return it->second;
+    }
+
+    // Stores a body for ttl. If the content is unchanged the old variants are
+    // reused and only the expiry moves, so refreshes don't recompress.
+    // delta_ms / source_ttl describe the Redis copy the body came from (for refresh-ahead).
+    std::shared_ptr<const CachedResponse> put(const std::string& key, const std::string& body,
+                                              std::chrono::milliseconds ttl,
+                                              const std::string& content_type = "application/json",
+                                              double delta_ms = 0,
+                                              std::chrono::milliseconds source_ttl = std::chrono::milliseconds(0)) {
+        std::string etag = strongEtag(body);
+        std::shared_ptr<const CachedResponse> previous;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end()) previous = it->second;
+        }
+
+        auto entry = std::make_shared<CachedResponse>();
+        entry->etag = etag;
+        entry->identity = body;
+        entry->content_type = content_type;
+        auto now = std::chrono::steady_clock::now();
+        entry->expires_at = now + ttl;
+        entry->delta_ms = delta_ms;
+        entry->source_expires_at = now + source_ttl;
+        if (previous && previous->etag == etag) {
+            entry->gzip = previous->gzip;
+            entry->br = previous->br;
+        } else {
+            // 🗜️ Compress once per content version. Keep a variant only if it actually saves bytes.
+            entry->gzip = Compression::gzip(body);
+            if (entry->gzip.size() >= body.size()) entry->gzip.clear();
+            entry->br = Compression::brotli(body);
+            if (entry->br.size() >= body.size()) entry->br.clear();
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        entries_[key] = entry;
+        if (++puts_since_purge_ >= PURGE_EVERY || entries_.size() > MAX_ENTRIES) purge(now);
+        return entry;
+    }
+
+    void invalidate(const std::string& key) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        entries_.erase(key);
+    }
+
+    // If-None-Match: "*" or any listed tag (weak or strong, any encoding) for this content.
+    // Encoded variants carry a suffix ("<hash>-gzip") so each representation has its own strong tag.
+    static bool notModified(const crow::request& req, const CachedResponse& entry) {
+        const std::string& inm = req.get_header_value("If-None-Match");
+        if (inm.empty()) return false;
+        if (inm.find('*') != std::string::npos) return true;
+        return inm.find(entry.etag.substr(0, entry.etag.size() - 1)) != std::string::npos;
+    }
+
+    // Build the HTTP response: 304, or the best precompressed variant the client accepts
+    static crow::response respond(const crow::request& req, const CachedResponse& entry) {
+        const std::string& accept = req.get_header_value("Accept-Encoding");
+        const std::string* body = &entry.identity;
+        std::string encoding;
+        if (!entry.br.empty() && acceptsEncoding(accept, "br")) { body = &entry.br; encoding = "br"; }
+        else if (!entry.gzip.empty() && acceptsEncoding(accept, "gzip")) { body = &entry.gzip; encoding = "gzip"; }
+
+        std::string etag = encoding.empty() ? entry.etag
+                         : entry.etag.substr(0, entry.etag.size() - 1) + "-" + encoding + "\"";
+
+        crow::response r(200);
+        if (notModified(req, entry)) {
+            r.code = 304;
+        } else {
+            r.body = *body;
+            r.add_header("Content-Type", entry.content_type);
+            if (!encoding.empty()) r.add_header("Content-Encoding", encoding);
+        }
+        r.add_header("ETag", etag);
+        r.add_header("Vary", "Accept-Encoding");
+        r.add_header("Cache-Control", "no-cache"); // Always revalidate, 304 makes that cheap
+        return r;
+    }
+};
+
+ResponseCache* ResponseCache::instance = nullptr;
+std::mutex ResponseCache::instance_mutex_;
@@ -0,0 +1,309 @@
+#pragma once
+#include "../db.h"
+#include "../redis_manager.h"
+#include "../metrics/Metrics.h"
+#include "../ledger/SeatLedger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 🎫 PER-SHOW AVAILABILITY ("47 seats left")
+// Three atomic counters per show: total seats, held (reserved, not paid), booked.
+// Every seat event (hold, payment, confirmed or released booking) is published on the "availability" Redis channel
+// and every node applies it, including the one that published it. Holds are tracked with
+// their expiry so a lapsed reservation gives its seat back without any message.
+//
+// Pub/sub can drop messages, so every RECONCILE_EVERY a reconciler corrects booked against the
+// master and held against the live hold table. It snapshots the counters first and adds only the
+// difference it found at that snapshot, so events applied while the query runs are kept.
+//
+// With a SeatLedger attached every applied event is also recorded there, and a restart seeds
+// the counters and the hold table from the ledger instead of starting empty (the first
+// reconcile then runs in the background rather than blocking startup).
+class ShowAvailability {
+public:
+    struct Summary {
+        int show_id;
+        int total;
+        int held;
+        int booked;
+        int available() const { return std::max(0, total - held - booked); }
+    };
+
+    static constexpr const char* CHANNEL = "availability";
+    static constexpr std::chrono::seconds RECONCILE_EVERY{30};
+
+private:
+    struct Counters {
+        std::atomic<int> total{0};
+        std::atomic<int> held{0};
+        std::atomic<int> booked{0};
+    };
+
+    struct Hold {
+        int show_id;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    static ShowAvailability* instance;
+    static std::mutex instance_mutex_;
+
+    mutable std::shared_mutex shows_mutex_; // Guards the map shape only; counters are atomics
+    std::unordered_map<int, std::unique_ptr<Counters>> shows_;
+
+    std::mutex holds_mutex_;
+    std::unordered_map<uint64_t, Hold> holds_; // (show << 32 | seat) -> hold
+    std::atomic<bool> running_{false};
+    SeatLedger* ledger_ = nullptr;
+    bool restored_ = false;
+
+    std::atomic<long long>* events_ = Metrics::GetInstance()->counter("availability.events");
+    std::atomic<long long>* drift_ = Metrics::GetInstance()->counter("availability.reconcile_drift");
+
+    ShowAvailability() {}
+
+    static uint64_t holdKey(int show_id, int seat_id) { return ((uint64_t)(uint32_t)show_id << 32) | (uint32_t)seat_id; }
+
+    static int64_t wallMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    Counters& counters(int show_id) {
+        {
+            std::shared_lock<std::shared_mutex> lock(shows_mutex_);
+            auto it = shows_.find(show_id);
+            if (it != shows_.end()) return *it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(shows_mutex_);
+        auto& slot = shows_[show_id];
+        if (!slot) slot = std::make_unique<Counters>();
+        return *slot;
+    }
+
+    // =========================================================
+    // EVENT APPLICATION (from the Redis channel)
+    // =========================================================
+    void applyHold(int show_id, int seat_id, int ttl_seconds) {
+        auto expires = std::chrono::steady_clock::now() + std::chrono::seconds(ttl_seconds);
+        bool fresh;
+        {
+            std::lock_guard<std::mutex> lock(holds_mutex_);
+            auto [it, inserted] = holds_.try_emplace(holdKey(show_id, seat_id), Hold{show_id, expires});
+            if (!inserted) it->second.expires_at = expires;
+            fresh = inserted;
+        }
+        if (fresh) counters(show_id).held.fetch_add(1, std::memory_order_relaxed);
+        if (ledger_) ledger_->record(SeatEvent::Type::RESERVED, show_id, seat_id, wallMs() + ttl_seconds * 1000LL);
+    }
+
+    // Payment accepted: the hold stays until the booking lands (or lapses)
+    void applyPaid(int show_id, int seat_id) {
+        if (ledger_) ledger_->record(SeatEvent::Type::PAID, show_id, seat_id);
+    }
+
+    // The booking failed: the seat goes back right away instead of at hold expiry
+    void applyReleased(int show_id, int seat_id) {
+        bool was_held;
+        {
+            std::lock_guard<std::mutex> lock(holds_mutex_);
+            was_held = holds_.erase(holdKey(show_id, seat_id)) > 0;
+        }
+        if (was_held) counters(show_id).held.fetch_sub(1, std::memory_order_relaxed);
+        if (ledger_) ledger_->record(SeatEvent::Type::RELEASED, show_id, seat_id);
+    }
+
+    void applyBooked(int show_id, int seat_id) {
+        bool was_held;
+        {
+            std::lock_guard<std::mutex> lock(holds_mutex_);
+            was_held = holds_.erase(holdKey(show_id, seat_id)) > 0;
+        }
+        Counters& c = counters(show_id);
+        if (was_held) c.held.fetch_sub(1, std::memory_order_relaxed);
+        c.booked.fetch_add(1, std::memory_order_relaxed);
+        if (ledger_) ledger_->record(SeatEvent::Type::CONFIRMED, show_id, seat_id);
+    }
+
+    void onMessage(const std::string& message) {
+        std::istringstream in(message);
+        std::string type;
+        int show_id = 0, seat_id = 0, ttl = 0;
+        in >> type >> show_id >> seat_id;
+        if (!in) return;
+        if (type == "HOLD" && (in >> ttl)) applyHold(show_id, seat_id, ttl);
+        else if (type == "BOOKED") applyBooked(show_id, seat_id);
+        else if (type == "PAID") applyPaid(show_id, seat_id);
+        else if (type == "RELEASED") applyReleased(show_id, seat_id);
+        else return;
+        events_->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Reservations whose Redis lock has lapsed give their seat back
+    void expireHolds() {
+        auto now = std::chrono::steady_clock::now();
+        std::vector<uint64_t> released;
+        {
+            std::lock_guard<std::mutex> lock(holds_mutex_);
+            for (auto it = holds_.begin(); it != holds_.end();) {
+                if (it->second.expires_at <= now) {
+                    released.push_back(it->first);
+                    it = holds_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (uint64_t key : released) {
+            int show_id = (int)(key >> 32), seat_id = (int)(uint32_t)key;
+            counters(show_id).held.fetch_sub(1, std::memory_order_relaxed);
+            if (ledger_) ledger_->record(SeatEvent::Type::EXPIRED, show_id, seat_id);
+        }
+    }
+
+public:
+    static ShowAvailability* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new ShowAvailability();
+        return instance;
+    }
+
+    // =========================================================
+    // PUBLISHERS (call after the Redis lock / the DB commit succeeded)
+    // =========================================================
+    static void publishHold(int show_id, int seat_id, int ttl_seconds) {
+        RedisManager::GetInstance()->publish(CHANNEL, "HOLD " + std::to_string(show_id) + " " + std::to_string(seat_id) + " " + std::to_string(ttl_seconds));
+    }
+
+    static void publishBooked(int show_id, int seat_id) {
+        RedisManager::GetInstance()->publish(CHANNEL, "BOOKED " + std::to_string(show_id) + " " + std::to_string(seat_id));
+    }
+
+    static void publishPaid(int show_id, int seat_id) {
+        RedisManager::GetInstance()->publish(CHANNEL, "PAID " + std::to_string(show_id) + " " + std::to_string(seat_id));
+    }
+
+    static void publishReleased(int show_id, int seat_id) {
+        RedisManager::GetInstance()->publish(CHANNEL, "RELEASED " + std::to_string(show_id) + " " + std::to_string(seat_id));
+    }
+
+    // =========================================================
+    // LEDGER (call before start())
+    // =========================================================
+    // Records every event from now on; seeds counters and holds from the ledger's recovered
+    // state. Returns true if there was anything to seed from.
+    bool attachLedger(SeatLedger* ledger) {
+        ledger_ = ledger;
+        auto seats = ledger->seats();
+        auto totals = ledger->totals();
+        if (seats.empty() && totals.empty()) return false;
+
+        int64_t now_ms = wallMs();
+        auto now = std::chrono::steady_clock::now();
+        for (const auto& [show_id, total] : totals) counters(show_id).total.store(total);
+        std::lock_guard<std::mutex> lock(holds_mutex_);
+        for (const auto& s : seats) {
+            Counters& c = counters(s.show_id);
+            if (s.state == SeatLedger::State::BOOKED) {
+                c.booked.fetch_add(1, std::memory_order_relaxed);
+            } else if (s.expires_ms > now_ms) {
+                holds_[holdKey(s.show_id, s.seat_id)] = Hold{s.show_id, now + std::chrono::milliseconds(s.expires_ms - now_ms)};
+                c.held.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        restored_ = true;
+        return true;
+    }
+
+    // =========================================================
+    // RECONCILIATION (Postgres is the truth for total/booked)
+    // =========================================================
+    void reconcile() {
+        // 📸 Snapshot: the hold table and every counter as they stand right now
+        std::unordered_map<int, int> held, held_seen, booked_seen;
+        {
+            std::lock_guard<std::mutex> holds_lock(holds_mutex_);
+            for (const auto& [key, hold] : holds_) held[hold.show_id]++;
+            std::shared_lock<std::shared_mutex> shows_lock(shows_mutex_);
+            for (const auto& [show_id, c] : shows_) {
+                held_seen[show_id] = c->held.load(std::memory_order_relaxed);
+                booked_seen[show_id] = c->booked.load(std::memory_order_relaxed);
+            }
+        }
+        long long drift = 0;
+        for (const auto& [show_id, seen] : held_seen) {
+            auto h = held.find(show_id);
+            int diff = (h == held.end() ? 0 : h->second) - seen;
+            if (diff) counters(show_id).held.fetch_add(diff, std::memory_order_relaxed);
+            drift += std::abs(diff);
+        }
+
+        // Master, not a replica: a lagging replica would undo bookings this node already applied
+        DBConnection conn(PoolType::MASTER);
+        pqxx::work txn(*conn);
+        pqxx::result res = txn.exec_prepared(Statements::AVAILABILITY_COUNTS);
+        std::unordered_map<int, int> totals;
+        for (auto row : res) {
+            int show_id = row[0].as<int>();
+            int total = row[1].as<int>(), booked = row[2].as<int>();
+            auto b = booked_seen.find(show_id);
+            int diff = booked - (b == booked_seen.end() ? 0 : b->second);
+            Counters& c = counters(show_id);
+            if (diff) c.booked.fetch_add(diff, std::memory_order_relaxed);
+            c.total.store(total);
+            drift += std::abs(diff);
+            totals[show_id] = total;
+        }
+        drift_->fetch_add(drift, std::memory_order_relaxed);
+        if (ledger_) ledger_->setTotals(std::move(totals));
+    }
+
+    // Subscribes to seat events and runs the expiry sweep + periodic reconcile
+    void start() {
+        if (running_.exchange(true)) return;
+        RedisManager::GetInstance()->subscribe(CHANNEL, [this](const std::string& message) { onMessage(message); });
+        std::thread([this] {
+            // Seeded from the ledger: Postgres hasn't been asked yet, so check it right away
+            auto last_reconcile = std::chrono::steady_clock::now() - (restored_ ? RECONCILE_EVERY : std::chrono::seconds(0));
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                expireHolds();
+                if (std::chrono::steady_clock::now() - last_reconcile < RECONCILE_EVERY) continue;
+                last_reconcile = std::chrono::steady_clock::now();
+                try { reconcile(); }
+                catch (const std::exception& e) { std::cerr << "⚠️ Availability reconcile failed: " << e.what() << std::endl; }
+            }
+        }).detach();
+    }
+
+    // =========================================================
+    // READS (lock-free apart from the shared map lookup)
+    // =========================================================
+    std::vector<Summary> get(const std::vector<int>& show_ids) const {
+        std::vector<Summary> out;
+        out.reserve(show_ids.size());
+        std::shared_lock<std::shared_mutex> lock(shows_mutex_);
+        for (int id : show_ids) {
+            auto it = shows_.find(id);
+            if (it == shows_.end()) continue; // Unknown show
+            const Counters& c = *it->second;
+            out.push_back({id, c.total.load(std::memory_order_relaxed), std::max(0, c.held.load(std::memory_order_relaxed)),
+                           c.booked.load(std::memory_order_relaxed)});
+        }
+        return out;
+    }
+};
+
+ShowAvailability* ShowAvailability::instance = nullptr;
+std::mutex ShowAvailability::instance_mutex_;
@@ -0,0 +1,227 @@
+#pragma once
+#include "../db.h"
+#include "../metrics/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// 🗂️ RESIDENT CATALOG INDEX
+// Every show, flattened into one 32-byte POD and kept in a sorted array:
+//   by_city_movie_time : (city, movie, start, show)  -> "movie X in city Y between 6pm and 10pm"
+//   by_theater_time    : positions sorted by (theater, start)
+// Range queries are two binary searches plus a linear scan over contiguous memory.
+//
+// Readers grab an immutable snapshot (shared_ptr), so they never block the refresher.
+// The refresher pulls only shows with id > high-water mark and merges them in;
+// a periodic full rebuild picks up edits and deletes.
+struct ShowEntry {
+    int32_t city_id;
+    int32_t movie_id;
+    int64_t start_epoch; // seconds
+    int32_t show_id;
+    int32_t theater_id;
+    int32_t screen_id;
+    int32_t price_cents;
+};
+
+class CatalogIndex {
+public:
+    struct Snapshot {
+        std::vector<ShowEntry> by_city_movie_time;
+        std::vector<uint32_t> by_theater_time; // Positions into by_city_movie_time
+        std::vector<int32_t> show_ids;         // Sorted, for hasShow()
+        std::unordered_map<int, std::string> movie_titles;
+        int max_show_id = 0;
+        uint64_t version = 0;
+    };
+
+private:
+    static CatalogIndex* instance;
+    static std::mutex instance_mutex_;
+
+    std::shared_ptr<const Snapshot> snapshot_ = std::make_shared<Snapshot>();
+    std::mutex refresh_mutex_; // Serializes writers only
+    std::atomic<bool> running_{false};
+    LatencyHistogram* query_us_ = Metrics::GetInstance()->histogram("catalog.index_query_us");
+
+    CatalogIndex() {}
+
+    static bool byCityMovieTime(const ShowEntry& a, const ShowEntry& b) {
+        return std::tie(a.city_id, a.movie_id, a.start_epoch, a.show_id) <
+               std::tie(b.city_id, b.movie_id, b.start_epoch, b.show_id);
+    }
+
+    // by_theater_time and show_ids, both derived from by_city_movie_time
+    static void buildSecondaryIndexes(Snapshot& snap) {
+        const auto& rows = snap.by_city_movie_time;
+        snap.by_theater_time.resize(rows.size());
+        for (uint32_t i = 0; i < rows.size(); i++) snap.by_theater_time[i] = i;
+        std::sort(snap.by_theater_time.begin(), snap.by_theater_time.end(), [&rows](uint32_t a, uint32_t b) {
+            return std::tie(rows[a].theater_id, rows[a].start_epoch) < std::tie(rows[b].theater_id, rows[b].start_epoch);
+        });
+        snap.show_ids.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) snap.show_ids[i] = rows[i].show_id;
+        std::sort(snap.show_ids.begin(), snap.show_ids.end());
+    }
+
+    // Shows with id > after_id, flattened with their city/theater and movie title
+    static void loadShows(int after_id, std::vector<ShowEntry>& out, std::unordered_map<int, std::string>& titles) {
+        DBConnection conn(PoolType::REPLICA);
+        pqxx::work txn(*conn);
+        pqxx::result res = txn.exec_prepared(Statements::CATALOG_INDEX_DELTA, after_id);
+        out.reserve(out.size() + res.size());
+        for (auto row : res) {
+            ShowEntry e;
+            e.show_id = row[0].as<int>();
+            e.city_id = row[1].as<int>();
+            e.theater_id = row[2].as<int>();
+            e.screen_id = row[3].as<int>();
+            e.movie_id = row[4].as<int>();
+            e.start_epoch = row[6].as<long long>();
+            e.price_cents = row[7].as<int>();
+            out.push_back(e);
+            titles.emplace(e.movie_id, row[5].as<std::string>());
+        }
+    }
+
+    void publish(std::shared_ptr<const Snapshot> snap) { std::atomic_store(&snapshot_, std::move(snap)); }
+
+public:
+    static CatalogIndex* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new CatalogIndex();
+        return instance;
+    }
+
+    std::shared_ptr<const Snapshot> snapshot() const { return std::atomic_load(&snapshot_); }
+
+    // =========================================================
+    // REFRESH
+    // =========================================================
+    void rebuild() {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        auto current = snapshot();
+        auto snap = std::make_shared<Snapshot>();
+        loadShows(0, snap->by_city_movie_time, snap->movie_titles);
+        std::sort(snap->by_city_movie_time.begin(), snap->by_city_movie_time.end(), byCityMovieTime);
+        for (const auto& e : snap->by_city_movie_time) snap->max_show_id = std::max(snap->max_show_id, e.show_id);
+        buildSecondaryIndexes(*snap);
+        snap->version = current->version + 1;
+        publish(snap);
+    }
+
+    // Pulls only new shows and merges them into a copy of the sorted array
+    size_t refreshIncremental() {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        auto current = snapshot();
+        std::vector<ShowEntry> fresh;
+        std::unordered_map<int, std::string> titles;
+        loadShows(current->max_show_id, fresh, titles);
+        if (fresh.empty()) return 0;
+
+        std::sort(fresh.begin(), fresh.end(), byCityMovieTime);
+        auto snap = std::make_shared<Snapshot>();
+        snap->by_city_movie_time.reserve(current->by_city_movie_time.size() + fresh.size());
+        std::merge(current->by_city_movie_time.begin(), current->by_city_movie_time.end(),
+                   fresh.begin(), fresh.end(), std::back_inserter(snap->by_city_movie_time), byCityMovieTime);
+        snap->movie_titles = current->movie_titles;
+        for (auto& [id, title] : titles) snap->movie_titles[id] = std::move(title);
+        snap->max_show_id = current->max_show_id;
+        for (const auto& e : fresh) snap->max_show_id = std::max(snap->max_show_id, e.show_id);
+        buildSecondaryIndexes(*snap);
+        snap->version = current->version + 1;
+        publish(snap);
+        return fresh.size();
+    }
+
+    // Background loop: cheap delta pulls often, a full rebuild now and then
+    void start(std::chrono::seconds delta_every = std::chrono::seconds(5),
+               std::chrono::seconds rebuild_every = std::chrono::seconds(600)) {
+        if (running_.exchange(true)) return;
+        std::thread([this, delta_every, rebuild_every] {
+            auto last_rebuild = std::chrono::steady_clock::now();
+            while (true) {
+                std::this_thread::sleep_for(delta_every);
+                try {
+                    if (std::chrono::steady_clock::now() - last_rebuild >= rebuild_every) {
+                        rebuild();
+                        last_rebuild = std::chrono::steady_clock::now();
+                    } else {
+                        refreshIncremental();
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "⚠️ Catalog index refresh failed: " << e.what() << std::endl;
+                }
+            }
+        }).detach();
+    }
+
+    // =========================================================
+    // LOOKUPS
+    // =========================================================
+    // False until the first load lands (a failed startup rebuild is retried in the background)
+    bool loaded() const { return snapshot()->version > 0; }
+
+    // Shows created since the last delta pull (<= delta_every ago) aren't known yet
+    bool hasShow(int show_id) const {
+        auto snap = snapshot();
+        return std::binary_search(snap->show_ids.begin(), snap->show_ids.end(), show_id);
+    }
+
+    // =========================================================
+    // RANGE QUERIES (start_epoch in [from, to])
+    // =========================================================
+    std::vector<ShowEntry> findByCityMovie(int city_id, int movie_id, int64_t from, int64_t to) const {
+        auto start = std::chrono::steady_clock::now();
+        auto snap = snapshot();
+        const auto& rows = snap->by_city_movie_time;
+        ShowEntry lo{city_id, movie_id, from, INT32_MIN, 0, 0, 0};
+        ShowEntry hi{city_id, movie_id, to, INT32_MAX, 0, 0, 0};
+        auto first = std::lower_bound(rows.begin(), rows.end(), lo, byCityMovieTime);
+        auto last = std::upper_bound(first, rows.end(), hi, byCityMovieTime);
+        std::vector<ShowEntry> out(first, last);
+        query_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        return out;
+    }
+
+    // All movies in a city: the city is one contiguous block, filtered by time
+    std::vector<ShowEntry> findByCity(int city_id, int64_t from, int64_t to) const {
+        auto start = std::chrono::steady_clock::now();
+        auto snap = snapshot();
+        const auto& rows = snap->by_city_movie_time;
+        auto first = std::lower_bound(rows.begin(), rows.end(), city_id, [](const ShowEntry& e, int c) { return e.city_id < c; });
+        std::vector<ShowEntry> out;
+        for (auto it = first; it != rows.end() && it->city_id == city_id; ++it) {
+            if (it->start_epoch >= from && it->start_epoch <= to) out.push_back(*it);
+        }
+        query_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        return out;
+    }
+
+    std::vector<ShowEntry> findByTheater(int theater_id, int64_t from, int64_t to) const {
+        auto start = std::chrono::steady_clock::now();
+        auto snap = snapshot();
+        const auto& rows = snap->by_city_movie_time;
+        const auto& idx = snap->by_theater_time;
+        auto key = [&rows](uint32_t i) { return std::make_tuple(rows[i].theater_id, rows[i].start_epoch); };
+        auto first = std::lower_bound(idx.begin(), idx.end(), std::make_tuple(theater_id, from),
+                                      [&](uint32_t i, const std::tuple<int32_t, int64_t>& k) { return key(i) < k; });
+        std::vector<ShowEntry> out;
+        for (auto it = first; it != idx.end() && rows[*it].theater_id == theater_id && rows[*it].start_epoch <= to; ++it) {
+            out.push_back(rows[*it]);
+        }
+        query_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        return out;
+    }
+};
+
+CatalogIndex* CatalogIndex::instance = nullptr;
+std::mutex CatalogIndex::instance_mutex_;
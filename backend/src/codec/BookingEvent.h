@@ -0,0 +1,116 @@
+#pragma once
+#include "Wire.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 🎟️ BOOKING EVENT (what goes through the outbox and the "bookings" queue)
+//
+//   Header : "TMBK" | u8 version | u8 flags | u16 fixed_size
+//   Fixed  : i32 user_id | i32 show_id | i64 amount_cents | i64 created_ms | u16 key_len | u16 seat_count
+//   Tail   : key_len bytes of idempotency key | seat_count x i32 seat_id
+//
+// Little-endian, fixed width, like ShowCodec. Forward compatible within a major version:
+// a newer writer may grow the fixed block (fixed_size tells readers how much to skip) or
+// append sections after the seats; older readers ignore both. A different version byte is
+// rejected, never misread.
+namespace BookingEvent {
+
+    constexpr char MAGIC[4] = {'T', 'M', 'B', 'K'};
+    constexpr uint8_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 4 + 1 + 1 + 2;
+    constexpr uint16_t FIXED_SIZE_V1 = 4 + 4 + 8 + 8 + 2 + 2;
+
+    struct Event {
+        int user_id = 0;
+        int show_id = 0;
+        std::vector<int> seat_ids;
+        int64_t amount_cents = 0;        // Money as integer cents
+        std::string idempotency_key;     // Client's Idempotency-Key, or one we generated
+        int64_t created_ms = 0;          // Unix epoch milliseconds
+    };
+
+    // Zero-copy decoded event: the key and the seat list point into the message buffer,
+    // which must outlive the view.
+    struct View {
+        int user_id = 0;
+        int show_id = 0;
+        int64_t amount_cents = 0;
+        int64_t created_ms = 0;
+        std::string_view idempotency_key;
+        const unsigned char* seats = nullptr;
+        uint16_t seat_count = 0;
+
+        int seat(size_t i) const { return (int)Wire::getU32(seats + 4 * i); }
+        std::vector<int> seatIds() const {
+            std::vector<int> out(seat_count);
+            for (size_t i = 0; i < seat_count; i++) out[i] = seat(i);
+            return out;
+        }
+    };
+
+    inline size_t encodedSize(const Event& e) {
+        return HEADER_SIZE + FIXED_SIZE_V1 + e.idempotency_key.size() + 4 * e.seat_ids.size();
+    }
+
+    // Appends to `out`, so a caller can reuse one buffer. Keys over 64KB / 65535 seats are truncated.
+    inline void encodeTo(std::string& out, const Event& e) {
+        using namespace Wire;
+        uint16_t key_len = (uint16_t)std::min<size_t>(e.idempotency_key.size(), UINT16_MAX);
+        uint16_t seat_count = (uint16_t)std::min<size_t>(e.seat_ids.size(), UINT16_MAX);
+        out.reserve(out.size() + encodedSize(e));
+        put(out, MAGIC, 4);
+        out.push_back((char)VERSION);
+        out.push_back(0); // flags
+        putU16(out, FIXED_SIZE_V1);
+        putU32(out, (uint32_t)e.user_id);
+        putU32(out, (uint32_t)e.show_id);
+        putU64(out, (uint64_t)e.amount_cents);
+        putU64(out, (uint64_t)e.created_ms);
+        putU16(out, key_len);
+        putU16(out, seat_count);
+        put(out, e.idempotency_key.data(), key_len);
+        for (size_t i = 0; i < seat_count; i++) putU32(out, (uint32_t)e.seat_ids[i]);
+    }
+
+    inline std::string encode(const Event& e) {
+        std::string out;
+        encodeTo(out, e);
+        return out;
+    }
+
+    // Cheap check before decoding (e.g. to tell events from legacy text messages)
+    inline bool isEvent(std::string_view data) {
+        return data.size() >= HEADER_SIZE && std::memcmp(data.data(), MAGIC, 4) == 0;
+    }
+
+    // Returns false on any malformed/foreign input (including a different version)
+    inline bool decode(std::string_view data, View& out) {
+        using namespace Wire;
+        const unsigned char* p = (const unsigned char*)data.data();
+        const unsigned char* end = p + data.size();
+        if (!isEvent(data) || p[4] != VERSION) return false;
+
+        uint16_t fixed_size = getU16(p + 6);
+        if (fixed_size < FIXED_SIZE_V1 || data.size() - HEADER_SIZE < fixed_size) return false;
+        p += HEADER_SIZE;
+
+        View v;
+        v.user_id = (int)getU32(p);
+        v.show_id = (int)getU32(p + 4);
+        v.amount_cents = (int64_t)getU64(p + 8);
+        v.created_ms = (int64_t)getU64(p + 16);
+        uint16_t key_len = getU16(p + 24);
+        v.seat_count = getU16(p + 26);
+        p += fixed_size; // Skips fields a newer writer added
+
+        if ((size_t)(end - p) < key_len + 4 * (size_t)v.seat_count) return false;
+        v.idempotency_key = std::string_view((const char*)p, key_len);
+        v.seats = p + key_len;
+        out = v;
+        return true;
+    }
+}
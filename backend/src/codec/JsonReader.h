@@ -0,0 +1,284 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TM_JSON_SSE2 1
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 🔎 ON-DEMAND JSON READER (request bodies on the hot POST routes)
+// Reads typed fields straight off the body's bytes instead of building a crow::json DOM.
+// One forward pass over a top-level object: the caller sees each key and either pulls the value
+// it wants (asInt, asIntArray) or lets the reader skip it. Everything is still validated (structure,
+// number grammar, string escapes, UTF-8, nesting depth, no trailing bytes), and the first bad
+// byte ends the pass, so garbage costs about as much as reading it once.
+//
+// With SSE2 the string and whitespace scans look at 16 bytes per step: one compare set flags
+// quote, backslash, control and non-ASCII bytes, and only those are handled one at a time.
+//
+//   int seat = -1;
+//   bool ok = JsonReader::forEachField(body, [&](std::string_view key, JsonReader::Value& v) {
+//       if (key == "seat_id") return v.asInt(seat);
+//       return true; // Anything else is skipped
+//   });
+//
+// Keys are compared as raw bytes: a key spelled with escapes doesn't match and is skipped.
+class JsonReader {
+public:
+    static constexpr int MAX_DEPTH = 32;
+
+    class Value {
+        JsonReader& r_;
+        bool consumed_ = false;
+        friend class JsonReader;
+        explicit Value(JsonReader& r) : r_(r) {}
+
+    public:
+        // A JSON integer (no fraction or exponent) that fits the target type
+        bool asInt64(int64_t& out) { consumed_ = true; return r_.readInt(out); }
+
+        bool asInt(int& out) {
+            int64_t v;
+            if (!asInt64(v) || v < std::numeric_limits<int>::min() || v > std::numeric_limits<int>::max()) return false;
+            out = (int)v;
+            return true;
+        }
+
+        // [int, ...] with at most max_items entries; appends to out
+        bool asIntArray(std::vector<int>& out, size_t max_items) { consumed_ = true; return r_.readIntArray(out, max_items); }
+
+        bool skip() { consumed_ = true; return r_.skipValue(1); }
+    };
+
+    // Walks a top-level object. on_field(key, value) returns false to reject the body; a value
+    // it doesn't consume is skipped (and validated). True only if the whole body is valid JSON.
+    template <class F>
+    static bool forEachField(std::string_view json, F&& on_field) {
+        JsonReader r(json);
+        r.skipSpace();
+        if (!r.consume('{')) return false;
+        r.skipSpace();
+        if (r.consume('}')) return r.finish();
+        while (true) {
+            std::string_view key;
+            if (!r.consume('"') || !r.scanString(&key)) return false;
+            r.skipSpace();
+            if (!r.consume(':')) return false;
+            r.skipSpace();
+            Value v(r);
+            if (!on_field(key, v)) return false;
+            if (!v.consumed_ && !r.skipValue(1)) return false;
+            r.skipSpace();
+            if (r.consume(',')) { r.skipSpace(); continue; }
+            if (r.consume('}')) return r.finish();
+            return false;
+        }
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+
+    explicit JsonReader(std::string_view json) : p_(json.data()), end_(json.data() + json.size()) {}
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    // Printable ASCII other than the two characters that end a plain run inside a string
+    static bool plain(unsigned char c) { return c >= 0x20 && c < 0x80 && c != '"' && c != '\\'; }
+
+#ifdef TM_JSON_SSE2
+    static int firstBit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long i;
+        _BitScanForward(&i, mask);
+        return (int)i;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+#endif
+
+    bool consume(char c) {
+        if (p_ >= end_ || *p_ != c) return false;
+        p_++;
+        return true;
+    }
+
+    bool finish() {
+        skipSpace();
+        return p_ == end_;
+    }
+
+    void skipSpace() {
+#ifdef TM_JSON_SSE2
+        // Long runs (padding) 16 bytes at a time
+        while (end_ - p_ >= 16 && isSpace(*p_)) {
+            __m128i v = _mm_loadu_si128((const __m128i*)p_);
+            __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+                                      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+            unsigned other = ~(unsigned)_mm_movemask_epi8(ws) & 0xFFFF;
+            if (other) { p_ += firstBit(other); return; }
+            p_ += 16;
+        }
+#endif
+        while (p_ < end_ && isSpace(*p_)) p_++;
+    }
+
+    // p_ just past the opening quote; leaves p_ past the closing one
+    bool scanString(std::string_view* raw) {
+        const char* start = p_;
+        while (true) {
+#ifdef TM_JSON_SSE2
+            while (end_ - p_ >= 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)p_);
+                // Signed compare: bytes >= 0x80 are negative, so this flags control and non-ASCII bytes together
+                __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                                               _mm_cmplt_epi8(v, _mm_set1_epi8(0x20)));
+                unsigned mask = (unsigned)_mm_movemask_epi8(special);
+                if (mask) { p_ += firstBit(mask); break; }
+                p_ += 16;
+            }
+#endif
+            while (p_ < end_ && plain((unsigned char)*p_)) p_++;
+            if (p_ >= end_) return false;
+            unsigned char c = (unsigned char)*p_;
+            if (c == '"') {
+                if (raw) *raw = std::string_view(start, p_ - start);
+                p_++;
+                return true;
+            }
+            if (c == '\\') { if (!scanEscape()) return false; }
+            else if (c < 0x20) return false;
+            else if (!scanUtf8()) return false;
+        }
+    }
+
+    bool scanEscape() {
+        if (end_ - p_ < 2) return false;
+        switch (p_[1]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                p_ += 2;
+                return true;
+            case 'u':
+                if (end_ - p_ < 6) return false;
+                for (int i = 2; i < 6; i++) {
+                    char h = p_[i];
+                    if (!isDigit(h) && !(h >= 'a' && h <= 'f') && !(h >= 'A' && h <= 'F')) return false;
+                }
+                p_ += 6;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // One multi-byte UTF-8 sequence (RFC 3629: no overlongs, no surrogates, nothing past U+10FFFF)
+    bool scanUtf8() {
+        const unsigned char* s = (const unsigned char*)p_;
+        unsigned char c = s[0], lo = 0x80, hi = 0xBF;
+        int n;
+        if (c >= 0xC2 && c <= 0xDF) n = 1;
+        else if (c >= 0xE0 && c <= 0xEF) { n = 2; if (c == 0xE0) lo = 0xA0; if (c == 0xED) hi = 0x9F; }
+        else if (c >= 0xF0 && c <= 0xF4) { n = 3; if (c == 0xF0) lo = 0x90; if (c == 0xF4) hi = 0x8F; }
+        else return false;
+        if (end_ - p_ < n + 1 || s[1] < lo || s[1] > hi) return false;
+        for (int i = 2; i <= n; i++) if ((s[i] & 0xC0) != 0x80) return false;
+        p_ += n + 1;
+        return true;
+    }
+
+    bool scanDigits() {
+        const char* s = p_;
+        while (p_ < end_ && isDigit(*p_)) p_++;
+        return p_ > s;
+    }
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool scanNumber(bool& integral) {
+        consume('-');
+        if (p_ >= end_) return false;
+        if (*p_ == '0') p_++;
+        else if (!isDigit(*p_) || !scanDigits()) return false;
+        integral = true;
+        if (consume('.')) {
+            integral = false;
+            if (!scanDigits()) return false;
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+            integral = false;
+            p_++;
+            if (!consume('+')) consume('-');
+            if (!scanDigits()) return false;
+        }
+        return true;
+    }
+
+    bool readInt(int64_t& out) {
+        const char* start = p_;
+        bool integral = false;
+        if (!scanNumber(integral) || !integral) return false;
+        auto res = std::from_chars(start, p_, out);
+        return res.ec == std::errc() && res.ptr == p_;
+    }
+
+    bool readIntArray(std::vector<int>& out, size_t max_items) {
+        if (!consume('[')) return false;
+        skipSpace();
+        if (consume(']')) return true;
+        for (size_t n = 1;; n++) {
+            int64_t v;
+            if (n > max_items || !readInt(v) || v < std::numeric_limits<int>::min() || v > std::numeric_limits<int>::max()) return false;
+            out.push_back((int)v);
+            skipSpace();
+            if (consume(']')) return true;
+            if (!consume(',')) return false;
+            skipSpace();
+        }
+    }
+
+    bool literal(std::string_view word) {
+        if ((size_t)(end_ - p_) < word.size() || std::string_view(p_, word.size()) != word) return false;
+        p_ += word.size();
+        return true;
+    }
+
+    bool skipValue(int depth) {
+        if (p_ >= end_) return false;
+        switch (*p_) {
+            case '"': p_++; return scanString(nullptr);
+            case '{': case '[': return depth < MAX_DEPTH && skipContainer(depth + 1);
+            case 't': return literal("true");
+            case 'f': return literal("false");
+            case 'n': return literal("null");
+            default: { bool integral; return scanNumber(integral); }
+        }
+    }
+
+    bool skipContainer(int depth) {
+        char close = *p_ == '{' ? '}' : ']';
+        p_++;
+        skipSpace();
+        if (consume(close)) return true;
+        while (true) {
+            if (close == '}') {
+                if (!consume('"') || !scanString(nullptr)) return false;
+                skipSpace();
+                if (!consume(':')) return false;
+                skipSpace();
+            }
+            if (!skipValue(depth)) return false;
+            skipSpace();
+            if (consume(close)) return true;
+            if (!consume(',')) return false;
+            skipSpace();
+        }
+    }
+};
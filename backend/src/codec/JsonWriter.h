@@ -0,0 +1,147 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// ✍️ STREAMING JSON WRITER
+// Appends straight into a caller-owned string: no DOM, no per-field maps, no stringstream.
+// Commas are tracked per nesting level, strings are escaped (quote, backslash and every control
+// character), numbers go through std::to_chars (shortest round-trip form for doubles).
+//
+// Response bodies should be built in JsonWriter::threadBuffer(): one string per worker thread,
+// cleared on every call but keeping its capacity, so steady-state serialization allocates nothing.
+// A body must be copied out (std::string(buf) / crow::response) before the thread's next use.
+//
+//   std::string& buf = JsonWriter::threadBuffer();
+//   JsonWriter w(buf);
+//   w.beginObject().field("id", 7).field("label", "A-12").endObject();
+class JsonWriter {
+public:
+    static constexpr int MAX_DEPTH = 64; // Nesting levels tracked (plenty for any response here)
+    static constexpr size_t KEEP_CAPACITY = 1 << 20; // A one-off huge body doesn't pin its memory forever
+
+private:
+    std::string& out_;
+    uint64_t has_items_ = 0; // Bit d: level d already holds a value (next one needs a comma)
+    int depth_ = 0;
+    bool after_key_ = false;
+
+    void separate() {
+        if (after_key_) { after_key_ = false; return; }
+        if (depth_ == 0) return;
+        uint64_t bit = 1ULL << (depth_ - 1);
+        if (has_items_ & bit) out_.push_back(',');
+        has_items_ |= bit;
+    }
+
+    void open(char c) {
+        separate();
+        out_.push_back(c);
+        has_items_ &= ~(1ULL << depth_);
+        depth_++;
+    }
+
+    void close(char c) {
+        out_.push_back(c);
+        depth_--;
+    }
+
+    static bool plain(unsigned char c) { return c >= 0x20 && c != '"' && c != '\\'; }
+
+    void quoted(std::string_view s) {
+        size_t i = 0;
+        while (i < s.size() && plain((unsigned char)s[i])) i++;
+        size_t at = out_.size();
+        out_.resize(at + s.size() + 2); // Common case: nothing to escape, one copy
+        char* p = &out_[at];
+        p[0] = '"';
+        std::memcpy(p + 1, s.data(), i);
+        if (i == s.size()) { p[i + 1] = '"'; return; }
+        out_.resize(at + 1 + i);
+        escapeTail(s.substr(i));
+        out_.push_back('"');
+    }
+
+    void escapeTail(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        size_t run = 0; // Start of the pending run of bytes that need no escaping
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = (unsigned char)s[i];
+            if (plain(c)) continue;
+            out_.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"':  out_.append("\\\"", 2); break;
+                case '\\': out_.append("\\\\", 2); break;
+                case '\n': out_.append("\\n", 2); break;
+                case '\r': out_.append("\\r", 2); break;
+                case '\t': out_.append("\\t", 2); break;
+                case '\b': out_.append("\\b", 2); break;
+                case '\f': out_.append("\\f", 2); break;
+                default: {
+                    char u[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+                    out_.append(u, 6);
+                }
+            }
+        }
+        out_.append(s.data() + run, s.size() - run);
+    }
+
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    // This thread's response buffer, emptied
+    static std::string& threadBuffer() {
+        thread_local std::string buf;
+        if (buf.capacity() > KEEP_CAPACITY) std::string().swap(buf);
+        buf.clear();
+        return buf;
+    }
+
+    JsonWriter& beginObject() { open('{'); return *this; }
+    JsonWriter& endObject() { close('}'); return *this; }
+    JsonWriter& beginArray() { open('['); return *this; }
+    JsonWriter& endArray() { close(']'); return *this; }
+
+    JsonWriter& key(std::string_view k) {
+        separate();
+        quoted(k);
+        out_.push_back(':');
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view s) { separate(); quoted(s); return *this; }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b) { separate(); out_.append(b ? "true" : "false"); return *this; }
+    JsonWriter& null() { separate(); out_.append("null", 4); return *this; }
+
+    template <class T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    JsonWriter& value(T n) {
+        separate();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), n);
+        out_.append(buf, res.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter& value(double d) {
+        separate();
+        if (d != d || d - d != 0) { out_.append("null", 4); return *this; } // NaN/inf aren't JSON
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), d);
+        out_.append(buf, res.ptr - buf);
+        return *this;
+    }
+
+    // Already-serialized JSON (a cached listing, a stored status document)
+    JsonWriter& raw(std::string_view json) { separate(); out_.append(json); return *this; }
+
+    template <class T>
+    JsonWriter& field(std::string_view k, const T& v) { key(k); return value(v); }
+};
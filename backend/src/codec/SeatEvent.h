@@ -0,0 +1,61 @@
+#pragma once
+#include "Wire.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 💺 SEAT EVENT (one record in the seat ledger, ledger/SeatLedger.h)
+//
+//   u8 type | i32 show_id | i32 seat_id | i64 at_ms | i64 expires_ms     (25 bytes, little-endian)
+//
+// expires_ms is the hold's wall-clock deadline for RESERVED/PAID and 0 otherwise; wall clock
+// because it has to mean the same thing after a restart.
+namespace SeatEvent {
+
+    enum class Type : uint8_t {
+        RESERVED = 1,   // Hold taken (or extended)
+        RELEASED = 2,   // Hold given back (booking failed)
+        PAID = 3,       // Payment accepted, booking in flight
+        CONFIRMED = 4,  // Booking committed
+        EXPIRED = 5,    // Hold lapsed
+    };
+
+    constexpr size_t SIZE = 1 + 4 + 4 + 8 + 8;
+
+    struct Event {
+        Type type = Type::RESERVED;
+        int show_id = 0;
+        int seat_id = 0;
+        int64_t at_ms = 0;
+        int64_t expires_ms = 0;
+    };
+
+    inline void encodeTo(std::string& out, const Event& e) {
+        using namespace Wire;
+        out.push_back((char)e.type);
+        putU32(out, (uint32_t)e.show_id);
+        putU32(out, (uint32_t)e.seat_id);
+        putU64(out, (uint64_t)e.at_ms);
+        putU64(out, (uint64_t)e.expires_ms);
+    }
+
+    inline std::string encode(const Event& e) {
+        std::string out;
+        out.reserve(SIZE);
+        encodeTo(out, e);
+        return out;
+    }
+
+    inline bool decode(std::string_view data, Event& out) {
+        using namespace Wire;
+        if (data.size() < SIZE) return false;
+        const unsigned char* p = (const unsigned char*)data.data();
+        if (p[0] < (uint8_t)Type::RESERVED || p[0] > (uint8_t)Type::EXPIRED) return false;
+        out.type = (Type)p[0];
+        out.show_id = (int)getU32(p + 1);
+        out.seat_id = (int)getU32(p + 5);
+        out.at_ms = (int64_t)getU64(p + 9);
+        out.expires_ms = (int64_t)getU64(p + 17);
+        return true;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "../models/Show.h"
+#include "Wire.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 📦 COMPACT BINARY ENCODING FOR std::vector<Show> (what we keep in Redis)
+//
+//   Header  : "TMSH" | u8 version | u8 flags | u16 record_size | u32 show_count | u32 string_count
+//   Strings : string_count x (u32 length | bytes)          <- movie titles + start times, deduplicated
+//   Records : show_count x (i32 id | u32 movie_idx | u32 time_idx | i64 price_cents)
+//
+// All integers are little-endian and fixed width. record_size lets a newer writer append
+// per-record fields; older readers skip the extra bytes. A different major version is a
+// cache miss, never a crash.
+namespace ShowCodec {
+
+    constexpr char MAGIC[4] = {'T', 'M', 'S', 'H'};
+    constexpr uint8_t VERSION = 1;
+    constexpr uint16_t RECORD_SIZE_V1 = 4 + 4 + 4 + 8;
+    constexpr size_t HEADER_SIZE = 4 + 1 + 1 + 2 + 4 + 4;
+
+    inline std::string encode(const std::vector<Show>& shows) {
+        using namespace Wire;
+        // 1. Build the string table (titles and times repeat a lot across a theater's shows)
+        std::vector<std::string_view> strings;
+        std::unordered_map<std::string_view, uint32_t> index;
+        std::vector<uint32_t> refs;
+        refs.reserve(shows.size() * 2);
+        size_t string_bytes = 0;
+        auto intern = [&](const std::string& s) {
+            auto it = index.find(s);
+            if (it != index.end()) return it->second;
+            uint32_t id = (uint32_t)strings.size();
+            strings.push_back(s);
+            index.emplace(s, id);
+            string_bytes += 4 + s.size();
+            return id;
+        };
+        for (const auto& show : shows) {
+            refs.push_back(intern(show.movie_name));
+            refs.push_back(intern(show.start_time));
+        }
+
+        // 2. Write header + strings + fixed-width records in one buffer
+        std::string out;
+        out.reserve(HEADER_SIZE + string_bytes + shows.size() * RECORD_SIZE_V1);
+        put(out, MAGIC, 4);
+        out.push_back((char)VERSION);
+        out.push_back(0); // flags
+        putU16(out, RECORD_SIZE_V1);
+        putU32(out, (uint32_t)shows.size());
+        putU32(out, (uint32_t)strings.size());
+        for (auto s : strings) {
+            putU32(out, (uint32_t)s.size());
+            put(out, s.data(), s.size());
+        }
+        for (size_t i = 0; i < shows.size(); i++) {
+            putU32(out, (uint32_t)shows[i].id);
+            putU32(out, refs[2 * i]);
+            putU32(out, refs[2 * i + 1]);
+            putU64(out, (uint64_t)std::llround(shows[i].price * 100.0)); // Money as integer cents
+        }
+        return out;
+    }
+
+    // Decodes into `out` (cleared first). Returns false on any malformed/foreign input.
+    inline bool decode(std::string_view data, std::vector<Show>& out) {
+        using namespace Wire;
+        out.clear();
+        const unsigned char* p = (const unsigned char*)data.data();
+        const unsigned char* end = p + data.size();
+        if (data.size() < HEADER_SIZE || std::memcmp(p, MAGIC, 4) != 0 || p[4] != VERSION) return false;
+
+        uint16_t record_size = getU16(p + 6);
+        uint32_t show_count = getU32(p + 8);
+        uint32_t string_count = getU32(p + 12);
+        if (record_size < RECORD_SIZE_V1) return false;
+        p += HEADER_SIZE;
+
+        // String table stays as views into the buffer: no allocation until a Show needs it
+        // Every string costs at least its 4-byte length, so a bigger count is a lie; check before reserving
+        if ((size_t)(end - p) / 4 < string_count) return false;
+        std::vector<std::string_view> strings;
+        strings.reserve(string_count);
+        for (uint32_t i = 0; i < string_count; i++) {
+            if (end - p < 4) return false;
+            uint32_t len = getU32(p);
+            p += 4;
+            if ((size_t)(end - p) < len) return false;
+            strings.emplace_back((const char*)p, len);
+            p += len;
+        }
+
+        if ((size_t)(end - p) / record_size < show_count) return false;
+        out.reserve(show_count);
+        for (uint32_t i = 0; i < show_count; i++, p += record_size) {
+            uint32_t movie_idx = getU32(p + 4);
+            uint32_t time_idx = getU32(p + 8);
+            if (movie_idx >= strings.size() || time_idx >= strings.size()) { out.clear(); return false; }
+            out.push_back({
+                (int)getU32(p),
+                std::string(strings[movie_idx]),
+                std::string(strings[time_idx]),
+                (double)(int64_t)getU64(p + 12) / 100.0
+            });
+        }
+        return true;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 🧱 Little-endian fixed-width primitives shared by the binary codecs
+namespace Wire {
+    inline void put(std::string& out, const void* p, size_t n) { out.append((const char*)p, n); }
+    inline void putU16(std::string& out, uint16_t v) { unsigned char b[2] = {(unsigned char)v, (unsigned char)(v >> 8)}; put(out, b, 2); }
+    inline void putU32(std::string& out, uint32_t v) {
+        unsigned char b[4];
+        for (int i = 0; i < 4; i++) b[i] = (unsigned char)(v >> (8 * i));
+        put(out, b, 4);
+    }
+    inline void putU64(std::string& out, uint64_t v) {
+        unsigned char b[8];
+        for (int i = 0; i < 8; i++) b[i] = (unsigned char)(v >> (8 * i));
+        put(out, b, 8);
+    }
+    inline uint16_t getU16(const unsigned char* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    inline uint32_t getU32(const unsigned char* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    inline uint64_t getU64(const unsigned char* p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+        return v;
+    }
+
+    // Hex text, for moving binary through text-only paths (SQL literals): "0a1f..."
+    inline std::string toHex(std::string_view bytes) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(bytes.size() * 2);
+        for (unsigned char c : bytes) {
+            out.push_back(digits[c >> 4]);
+            out.push_back(digits[c & 15]);
+        }
+        return out;
+    }
+
+    // false on odd length or a non-hex digit
+    inline bool fromHex(std::string_view hex, std::string& out) {
+        auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        if (hex.size() % 2) return false;
+        out.clear();
+        out.reserve(hex.size() / 2);
+        for (size_t i = 0; i < hex.size(); i += 2) {
+            int hi = nibble(hex[i]), lo = nibble(hex[i + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out.push_back((char)((hi << 4) | lo));
+        }
+        return true;
+    }
+}
@@ -0,0 +1,255 @@
+// 👷 BOOKING CONSUMER (replaces worker.py)
+// Drains the "bookings" queue the server's outbox relay publishes to (binary BookingEvents,
+// codec/BookingEvent.h; the old "BOOK <seat_id> <user_id> [show_id]" text is still accepted).
+//   - Large prefetch: RabbitMQ keeps a window of messages in flight instead of one at a time
+//   - Batched writes: everything that arrived together goes into ONE transaction (BookingDAO::createBookings)
+//   - Acks only after commit, with multiple=true: one ack frame per batch
+// Malformed or failing bookings are dead-lettered (reject, no requeue); if the whole batch
+// fails (DB down) every message in it is requeued for the next attempt.
+// Delivery is at-least-once (outbox relay, requeues), so bookings are deduped on the event's
+// idempotency key: a redelivered event resolves to the booking it already made.
+// Every committed seat is announced on the availability channel so the servers' counters move,
+// and each user's read-your-writes token is bumped so /api/my-bookings shows the new booking.
+// Each event's intent is settled (CONFIRMED/FAILED) in outbox/IntentStatus.h, which wakes the
+// client's long-poll on /api/bookings/status.
+// With TM_BOOKING_QUEUE=log it tails the embedded log (messaging/MmapLog.h) instead of RabbitMQ;
+// there the committed offset is the ack and unreadable/rejected records are logged and skipped.
+// Batch outcomes are counted in Metrics (consumer.*) and summarized in the log every STATS_EVERY.
+#include "db.h"
+#include "dao/BookingDAO.h"
+#include "codec/BookingEvent.h"
+#include "catalog/Availability.h"
+#include "outbox/IntentStatus.h"
+#include "redis_manager.h"
+#include "messaging/MmapLog.h"
+#include "metrics/Metrics.h"
+#include <SimpleAmqpClient/SimpleAmqpClient.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const std::string QUEUE = "bookings";
+const uint16_t PREFETCH = 1000;     // Unacked messages RabbitMQ may push ahead of us
+const size_t MAX_BATCH = 500;       // Bookings per transaction
+const int BATCH_LINGER_MS = 5;      // How long to wait for the next message before flushing
+const std::string LOG_CONSUMER = "booking_consumer"; // Offset file name in the embedded log
+
+// Same defaults the server uses
+const int DEFAULT_SHOW_ID = 1;
+const double DEFAULT_AMOUNT = 50.0;
+
+// 🔖 Read-your-writes token, same key the server's /api/my-bookings reads
+const std::string SESSION_LSN_PREFIX = "rw:lsn:user:";
+const int SESSION_LSN_TTL_S = 300;
+
+const std::chrono::seconds STATS_EVERY{30};
+
+// 📊 One committed batch: new bookings, redeliveries of existing ones, and DB rejections
+void recordBatch(const std::vector<int>& ids, const std::vector<bool>& duplicates) {
+    static auto* metrics = Metrics::GetInstance();
+    static auto* committed = metrics->counter("consumer.committed");
+    static auto* deduped = metrics->counter("consumer.duplicates");
+    static auto* rejected = metrics->counter("consumer.rejected");
+    static auto* batch_size = metrics->histogram("consumer.batch_size");
+    if (ids.empty()) return;
+    long long fresh = 0, dup = 0, bad = 0;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (ids[i] < 0) bad++;
+        else if (duplicates[i]) dup++;
+        else fresh++;
+    }
+    committed->fetch_add(fresh, std::memory_order_relaxed);
+    deduped->fetch_add(dup, std::memory_order_relaxed);
+    rejected->fetch_add(bad, std::memory_order_relaxed);
+    batch_size->record(ids.size());
+}
+
+// One line per STATS_EVERY instead of one per batch (quiet while idle)
+void startStatsLog() {
+    std::thread([] {
+        auto* metrics = Metrics::GetInstance();
+        auto* committed = metrics->counter("consumer.committed");
+        auto* deduped = metrics->counter("consumer.duplicates");
+        auto* rejected = metrics->counter("consumer.rejected");
+        long long last[3] = {0, 0, 0};
+        while (true) {
+            std::this_thread::sleep_for(STATS_EVERY);
+            long long now[3] = {committed->load(), deduped->load(), rejected->load()};
+            if (now[0] == last[0] && now[1] == last[1] && now[2] == last[2]) continue;
+            std::cout << "📊 Last " << STATS_EVERY.count() << "s: " << (now[0] - last[0]) << " booked, " << (now[1] - last[1])
+                      << " duplicates, " << (now[2] - last[2]) << " rejected" << std::endl;
+            std::copy(now, now + 3, last);
+        }
+    }).detach();
+}
+
+// BookingEvent, or legacy "BOOK <seat_id> <user_id> [show_id]"
+// `intent` gets the event's intent id (empty for legacy messages, which have none)
+bool parseBooking(const std::string& body, NewBooking& out, std::string& intent) {
+    intent.clear();
+    if (BookingEvent::isEvent(body)) {
+        BookingEvent::View event;
+        if (!BookingEvent::decode(body, event) || event.seat_count == 0) return false;
+        intent = std::string(event.idempotency_key);
+        out = {event.user_id, event.show_id, event.seatIds(), event.amount_cents / 100.0, intent};
+        return true;
+    }
+    std::istringstream in(body);
+    std::string action;
+    int seat_id, user_id, show_id = DEFAULT_SHOW_ID;
+    if (!(in >> action >> seat_id >> user_id) || action != "BOOK") return false;
+    if (!(in >> show_id)) show_id = DEFAULT_SHOW_ID; // Older messages carry no show
+    out = {user_id, show_id, {seat_id}, DEFAULT_AMOUNT};
+    return true;
+}
+
+AmqpClient::Channel::ptr_t connect(const std::string& host) {
+    auto channel = AmqpClient::Channel::Create(host);
+    channel->DeclareQueue(QUEUE, false, true, false, false); // Durable, same as the server
+    return channel;
+}
+
+// Committed batch: settle each intent, move the availability counters (failed bookings give their holds back), bump each user's read-your-writes token
+// Duplicates (already booked by an earlier delivery) only settle their intent again; their seats were announced then.
+void announce(const std::vector<NewBooking>& bookings, const std::vector<std::string>& intents, const std::vector<int>& ids,
+              const std::vector<bool>& duplicates) {
+    std::set<int> users;
+    for (size_t i = 0; i < bookings.size(); i++) {
+        if (!intents[i].empty()) IntentStatus::markDone(intents[i], ids[i]);
+        if (duplicates[i]) continue;
+        if (ids[i] < 0) {
+            for (int seat : bookings[i].seat_ids) ShowAvailability::publishReleased(bookings[i].show_id, seat);
+            continue;
+        }
+        users.insert(bookings[i].user_id);
+        for (int seat : bookings[i].seat_ids) ShowAvailability::publishBooked(bookings[i].show_id, seat);
+    }
+    std::string lsn = Lsn::format(DBPool::GetInstance()->lastWriteLsn());
+    for (int user : users) RedisManager::GetInstance()->setSession(SESSION_LSN_PREFIX + std::to_string(user), lsn, SESSION_LSN_TTL_S);
+}
+
+// 🐰 RabbitMQ transport
+void runAmqp(const std::string& host) {
+    while (true) {
+        try {
+            auto channel = connect(host);
+            // no_ack=false: we ack manually, after the commit
+            std::string tag = channel->BasicConsume(QUEUE, "", true, false, false, PREFETCH);
+
+            while (true) {
+                std::vector<AmqpClient::Envelope::ptr_t> envelopes;
+                AmqpClient::Envelope::ptr_t env;
+                channel->BasicConsumeMessage(tag, env); // Block for the first one
+                envelopes.push_back(env);
+                while (envelopes.size() < MAX_BATCH && channel->BasicConsumeMessage(tag, env, BATCH_LINGER_MS)) {
+                    envelopes.push_back(env);
+                }
+
+                // Parse; anything unreadable goes straight to the dead-letter path
+                std::vector<NewBooking> bookings;
+                std::vector<std::string> intents;
+                std::vector<AmqpClient::Envelope::ptr_t> accepted;
+                for (auto& e : envelopes) {
+                    NewBooking b;
+                    std::string intent;
+                    if (parseBooking(e->Message()->Body(), b, intent)) {
+                        bookings.push_back(std::move(b));
+                        intents.push_back(std::move(intent));
+                        accepted.push_back(e);
+                    } else {
+                        std::cerr << "❌ Invalid Message Format (" << e->Message()->Body().size() << " bytes)" << std::endl;
+                        channel->BasicReject(e, false);
+                    }
+                }
+                if (bookings.empty()) continue;
+
+                std::vector<int> ids;
+                std::vector<bool> duplicates;
+                try {
+                    ids = BookingDAO::createBookings(bookings, &duplicates);
+                } catch (const std::exception& e) {
+                    // 🔄 Nothing committed: hand the whole batch back and back off
+                    std::cerr << "🔥 Batch of " << accepted.size() << " failed, requeueing: " << e.what() << std::endl;
+                    channel->BasicReject(accepted.back(), true, true); // multiple=true: the whole batch
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                    continue;
+                }
+
+                // Committed. Dead-letter the individual failures, then one multiple-ack for the rest.
+                AmqpClient::Envelope::ptr_t last_ok;
+                for (size_t i = 0; i < accepted.size(); i++) {
+                    if (ids[i] < 0) channel->BasicReject(accepted[i], false);
+                    else last_ok = accepted[i];
+                }
+                announce(bookings, intents, ids, duplicates);
+                if (last_ok) channel->BasicAck(last_ok->GetDeliveryInfo(), true);
+                recordBatch(ids, duplicates);
+            }
+        } catch (const std::exception& e) {
+            // Broker gone: unacked messages are redelivered once we reconnect
+            std::cerr << "⚠️ RabbitMQ Warning: " << e.what() << " (reconnecting)" << std::endl;
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+        }
+    }
+}
+
+// 🪵 Embedded log transport (TM_BOOKING_QUEUE=log, same TM_LOG_DIR as the server).
+// The committed offset plays the ack: it only moves after the DB commit.
+void runLog() {
+    LogReader reader(LOG_CONSUMER);
+    std::cout << "🪵 Reading booking log from offset " << reader.committed() << std::endl;
+    while (true) {
+        auto records = reader.poll(MAX_BATCH, std::chrono::milliseconds(1000));
+        if (records.empty()) continue;
+
+        std::vector<NewBooking> bookings;
+        std::vector<std::string> intents;
+        for (auto& r : records) {
+            NewBooking b;
+            std::string intent;
+            if (parseBooking(r.body, b, intent)) {
+                bookings.push_back(std::move(b));
+                intents.push_back(std::move(intent));
+            } else {
+                std::cerr << "❌ Invalid Message Format (" << r.body.size() << " bytes), skipped" << std::endl;
+            }
+        }
+
+        std::vector<int> ids;
+        std::vector<bool> duplicates;
+        try {
+            if (!bookings.empty()) ids = BookingDAO::createBookings(bookings, &duplicates);
+        } catch (const std::exception& e) {
+            std::cerr << "🔥 Batch of " << bookings.size() << " failed, retrying: " << e.what() << std::endl;
+            reader.rewind();
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+        size_t confirmed = std::count_if(ids.begin(), ids.end(), [](int id) { return id >= 0; });
+        if (confirmed < bookings.size()) std::cerr << "❌ " << (bookings.size() - confirmed) << " bookings rejected by the DB, skipped" << std::endl;
+        announce(bookings, intents, ids, duplicates);
+        reader.commit(records.back().next);
+        recordBatch(ids, duplicates);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* host_env = std::getenv("TM_AMQP_HOST");
+    std::string host = host_env ? host_env : "127.0.0.1";
+    const char* transport = std::getenv("TM_BOOKING_QUEUE");
+
+    DBPool::GetInstance(); // Warm the MASTER pool (and its prepared statements) up front
+    std::cout << "👷 Booking consumer started (prefetch " << PREFETCH << ", batch " << MAX_BATCH << ")" << std::endl;
+    startStatsLog();
+
+    if (transport && std::string(transport) == "log") runLog();
+    else runAmqp(host);
+    return 0;
+}
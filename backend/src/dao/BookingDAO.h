@@ -1,68 +1,142 @@
 #pragma once
 #include "../db.h"
 #include "../models/Booking.h"
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string>
 #include <vector>
 #include <iostream>
+#include <stdexcept>
+
+struct NewBooking {
+    int user_id;
+    int show_id;
+    std::vector<int> seat_ids;
+    double amount;
+    std::string idempotency_key = ""; // BookingEvent key; empty = no dedupe
+};
 
 class BookingDAO {
 public:
+    // Above this many seats, links go in through COPY instead of one big array parameter
+    static constexpr size_t COPY_THRESHOLD = 256;
+
+    // 📄 History paging
+    static constexpr int FIRST_PAGE = std::numeric_limits<int>::max(); // Cursor meaning "start from the newest"
+    static constexpr int DEFAULT_PAGE_SIZE = 50;
+    static constexpr int MAX_PAGE_SIZE = 1000;
+    static int clampPage(int limit) { return std::max(1, std::min(limit, MAX_PAGE_SIZE)); }
+
     // =========================================================
-    // 1. CREATE BOOKING (WRITE -> MASTER POOL)
+    // 1. CREATE BOOKINGS (WRITE -> MASTER POOL)
     // =========================================================
-    // Takes a user, a show, and a LIST of seat IDs.
-    // Returns the new Booking ID.
-    static int createBooking(int user_id, int show_id, const std::vector<int>& seat_ids, double amount) {
-        try {
-            // 🔴 USE MASTER (Because we are INSERTING data)
-            DBConnection conn(PoolType::MASTER);
-            pqxx::work txn(*conn); 
+    // One round trip for the usual case: the booking row and all seat links are a single
+    // statement (unnest of an int array). Huge group bookings stream their links via COPY.
+    // Runs on a caller-owned transaction (or savepoint).
+    // Throws on failure; the caller decides what to roll back.
+    // With an idempotency key, a booking that already exists for it is returned instead of a
+    // second one (`existed` set): the queue is at-least-once, so events do come back.
+    static int insertBooking(pqxx::transaction_base& txn, int user_id, int show_id, const std::vector<int>& seat_ids, double amount,
+                             const std::string& idempotency_key = "", bool* existed = nullptr) {
+        std::optional<std::string> key;
+        if (!idempotency_key.empty()) key = idempotency_key;
+        if (existed) *existed = false;
+        auto existing = [&]() {
+            pqxx::result res = txn.exec_prepared(Statements::BOOKING_BY_KEY, idempotency_key);
+            if (res.empty()) throw std::runtime_error("booking insert returned nothing");
+            if (existed) *existed = true;
+            return res[0][0].as<int>();
+        };
 
-            // A. Insert the main Booking Record
-            pqxx::result res = txn.exec_params(
-                "INSERT INTO bookings (user_id, show_id, status, total_amount) VALUES ($1, $2, 'CONFIRMED', $3) RETURNING id",
-                user_id, show_id, amount
+        if (!seat_ids.empty() && seat_ids.size() < COPY_THRESHOLD) {
+            // A + B. Booking record and seat links together
+            pqxx::result res = txn.exec_prepared(
+                Statements::BOOKING_WITH_SEATS,
+                user_id, show_id, amount, Statements::intArray(seat_ids), key
             );
-            int booking_id = res[0][0].as<int>();
+            if (res.empty() && key) return existing();
+            if (res.size() != seat_ids.size()) throw std::runtime_error("seat link count mismatch");
+            return res[0][0].as<int>();
+        }
 
-            // B. Link the Seats
-            for (int seat_id : seat_ids) {
-                txn.exec_params(
-                    "INSERT INTO booking_seats (booking_id, screen_seat_id) VALUES ($1, $2)",
-                    booking_id, seat_id
-                );
-            }
+        // A. Insert the main Booking Record
+        pqxx::result inserted = txn.exec_prepared(Statements::BOOKING_INSERT, user_id, show_id, amount, key);
+        if (inserted.empty()) return existing();
+        int booking_id = inserted[0][0].as<int>();
+        if (seat_ids.empty()) return booking_id;
 
-            txn.commit(); // ✅ All or Nothing commit
-            return booking_id;
+        // B. Stream the seat links (COPY is all-or-nothing, so the set is exactly seat_ids)
+        auto stream = pqxx::stream_to::table(txn, {"booking_seats"}, {"booking_id", "screen_seat_id"});
+        for (int seat_id : seat_ids) stream.write_values(booking_id, seat_id);
+        stream.complete();
+        return booking_id;
+    }
 
+    // 🔖 Remember how far master's WAL is past this commit (read-your-writes tokens).
+    // The booking is already durable, so a failure here is only logged.
+    static void noteCommit(pqxx::connection& conn) {
+        try {
+            DBPool::GetInstance()->recordCommit(conn);
         } catch (const std::exception& e) {
-            std::cerr << "❌ BookingDAO Error: " << e.what() << std::endl;
-            return -1; // Failed
+            std::cerr << "⚠️ Could not read commit LSN: " << e.what() << std::endl;
         }
     }
 
+    // Many bookings, ONE transaction and one commit. Each booking gets its own savepoint,
+    // so a bad one rolls back alone: its slot in the result is -1.
+    // A booking whose idempotency key was already booked gets the existing id, and (if asked)
+    // its slot in `duplicates` is set, so callers don't announce it twice.
+    // Throws if the batch as a whole fails (no connection, commit error) - nothing is durable then.
+    static std::vector<int> createBookings(const std::vector<NewBooking>& bookings, std::vector<bool>* duplicates = nullptr) {
+        std::vector<int> ids(bookings.size(), -1);
+        if (duplicates) duplicates->assign(bookings.size(), false);
+        DBConnection conn(PoolType::MASTER);
+        pqxx::work txn(*conn);
+        for (size_t i = 0; i < bookings.size(); i++) {
+            const NewBooking& b = bookings[i];
+            try {
+                pqxx::subtransaction savepoint(txn);
+                bool existed = false;
+                ids[i] = insertBooking(savepoint, b.user_id, b.show_id, b.seat_ids, b.amount, b.idempotency_key, &existed);
+                if (duplicates) (*duplicates)[i] = existed;
+                savepoint.commit();
+            } catch (const std::exception& e) {
+                ids[i] = -1; // Savepoint rolled back; the rest of the batch carries on
+                std::cerr << "❌ Booking in batch failed: " << e.what() << std::endl;
+            }
+        }
+        txn.commit(); // ✅ One fsync for the whole batch
+        noteCommit(*conn);
+        return ids;
+    }
+
     // =========================================================
     // 2. GET USER HISTORY (READ -> REPLICA POOL)
     // =========================================================
-    static std::vector<Booking> getBookingsByUser(int user_id) {
-        std::vector<Booking> list;
-        try {
-            // 🟢 USE REPLICA (Because we are only SELECTING)
-            DBConnection conn(PoolType::REPLICA);
-            pqxx::work txn(*conn);
-            
-            pqxx::result res = txn.exec_params(
-                "SELECT id, user_id, show_id, status, total_amount, booking_time FROM bookings WHERE user_id = $1 ORDER BY id DESC",
-                user_id
-            );
-
-            for (auto row : res) {
-                list.push_back({
-                    row[0].as<int>(), row[1].as<int>(), row[2].as<int>(),
-                    row[3].as<std::string>(), row[4].as<double>(), row[5].as<std::string>()
-                });
+    // Walks a user's whole history one page at a time (bounded memory, one short borrow per page).
+    // Stops early if `on_page` returns false. Throws on DB errors so a half-written export is noticed.
+    template <class F>
+    static void forEachBookingPage(int user_id, int page_size, uint64_t min_lsn, F&& on_page) {
+        int cursor = FIRST_PAGE;
+        page_size = clampPage(page_size);
+        while (true) {
+            std::vector<Booking> page;
+            {
+                DBConnection conn(PoolType::REPLICA, min_lsn);
+                pqxx::work txn(*conn);
+                pqxx::result res = txn.exec_prepared(Statements::BOOKINGS_BY_USER, user_id, cursor, page_size);
+                page.reserve(res.size());
+                for (auto row : res) {
+                    page.push_back({
+                        row[0].as<int>(), row[1].as<int>(), row[2].as<int>(),
+                        row[3].as<std::string>(), row[4].as<double>(), row[5].as<std::string>()
+                    });
+                }
             }
-        } catch (...) {}
-        return list;
+            if (page.empty() || !on_page(page)) return;
+            if ((int)page.size() < page_size) return;
+            cursor = page.back().id;
+        }
     }
-};
\ No newline at end of file
+};
@@ -1,66 +1,141 @@
 #pragma once
 #include "../db.h"
 #include "../redis_manager.h"
+#include "../metrics/Metrics.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
-#include <crow/json.h>
-
-struct Show {
-    int id;
-    std::string movie_name;
-    std::string start_time;
-    double price;
-};
+#include "../models/Show.h"
+#include "../codec/ShowCodec.h"
 
 class CatalogDAO {
 public:
-    static std::vector<Show> getShows(int theater_id) {
-        auto* redis = RedisManager::GetInstance();
-        std::string cache_key = "shows:theater:" + std::to_string(theater_id);
-
-        // 1. FAST PATH: Check Redis
-        auto cached = redis->getSession(cache_key);
-        if (cached) {
-            std::cout << "🚀 Cache Hit! Serving from Redis." << std::endl;
-            // In real world, we'd parse this JSON string back to objects.
-            // For now, we return empty vector to signal "Use the string directly" 
-            // (Simplified for this C++ example)
-            return {}; 
+    // One TTL for every catalog key (the route and the DAO used to disagree: 30s vs 300s)
+    static constexpr int CACHE_TTL_SECONDS = 30;
+
+    // Per-key metrics are capped: each key is a counter + histogram that lives forever
+    static constexpr size_t MAX_METRIC_KEYS = 256;
+
+    static std::string cacheKey(int theater_id) {
+        return "shows:theater:" + std::to_string(theater_id);
+    }
+
+    // 📊 Metric suffix for a recompute: the cache key for real theaters (ones that returned rows)
+    // up to MAX_METRIC_KEYS of them; unknown ids and everything past the cap share "other"
+    static std::string metricKey(int theater_id, bool has_rows) {
+        static std::mutex mutex;
+        static std::unordered_set<int> tracked;
+        if (has_rows) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tracked.count(theater_id) || tracked.size() < MAX_METRIC_KEYS) {
+                tracked.insert(theater_id);
+                return cacheKey(theater_id);
+            }
         }
+        return "other";
+    }
 
-        // 2. SLOW PATH: Check DB
-        std::cout << "🐌 Cache Miss. Hitting Postgres..." << std::endl;
-        std::vector<Show> shows;
-        try {
-            DBConnection conn;
-            pqxx::work txn(*conn);
-            // Complex Join: Show -> Movie
-            pqxx::result res = txn.exec_params(
-                "SELECT s.id, m.title, s.start_time, s.price_standard "
-                "FROM shows s JOIN movies m ON s.movie_id = m.id "
-                "WHERE s.screen_id IN (SELECT id FROM screens WHERE theater_id = $1)",
-                theater_id
-            );
-
-            crow::json::wvalue json_arr;
-            int i = 0;
-            for (auto row : res) {
-                shows.push_back({
-                    row[0].as<int>(), row[1].as<std::string>(), 
-                    row[2].as<std::string>(), row[3].as<double>()
-                });
-                // Build JSON for cache
-                json_arr[i]["id"] = row[0].as<int>();
-                json_arr[i]["movie"] = row[1].as<std::string>();
-                json_arr[i]["time"] = row[2].as<std::string>();
-                json_arr[i]["price"] = row[3].as<double>();
-                i++;
+    // =========================================================
+    // RECOMPUTE + WRITE BACK (used by misses AND refresh-ahead)
+    // =========================================================
+    // Times the Postgres load and stores it next to the value as the XFetch "delta".
+    // The cache holds the compact ShowCodec encoding; JSON is rendered by the route.
+    // Throws on DB errors so callers can decide what to serve. `delta_ms` (optional) receives that delta.
+    static std::vector<Show> refreshCache(int theater_id, double* delta_ms = nullptr) {
+        std::string cache_key = cacheKey(theater_id);
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<Show> shows = loadShows(theater_id);
+
+        auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        RedisManager::GetInstance()->setWithMeta(cache_key, ShowCodec::encode(shows), CACHE_TTL_SECONDS, elapsed_us / 1000.0);
+        if (delta_ms) *delta_ms = elapsed_us / 1000.0;
+
+        // 📊 Per-key stats: how often we recompute, and what it costs
+        auto* metrics = Metrics::GetInstance();
+        std::string metric_key = metricKey(theater_id, !shows.empty());
+        metrics->counter("catalog.refresh_count:" + metric_key)->fetch_add(1, std::memory_order_relaxed);
+        metrics->histogram("catalog.recompute_us:" + metric_key)->record(elapsed_us);
+
+        return shows;
+    }
+
+    // =========================================================
+    // BATCH LOOKUP (city pages): 1 MGET + 1 SQL (theater_id = ANY) for all misses + 1 pipelined SET
+    // =========================================================
+    // Returns theater_id -> shows for every requested theater (empty list if it has none).
+    // `misses` (optional) receives how many theaters had to be loaded from Postgres.
+    static std::map<int, std::vector<Show>> getShowsBatch(const std::vector<int>& theater_ids, size_t* misses = nullptr) {
+        auto* redis = RedisManager::GetInstance();
+        std::map<int, std::vector<Show>> result;
+
+        // 1. FAST PATH: One MGET for every key
+        std::vector<std::string> keys;
+        keys.reserve(theater_ids.size());
+        for (int id : theater_ids) keys.push_back(cacheKey(id));
+        auto cached = redis->getMany(keys);
+
+        std::vector<int> missing;
+        for (size_t i = 0; i < theater_ids.size(); i++) {
+            std::vector<Show> shows;
+            if (i < cached.size() && cached[i] && ShowCodec::decode(*cached[i], shows)) {
+                result[theater_ids[i]] = std::move(shows);
+            } else {
+                missing.push_back(theater_ids[i]);
             }
+        }
+        if (misses) *misses = missing.size();
+        if (missing.empty()) return result;
+
+        // 2. SLOW PATH: One set-based query for every miss
+        auto start = std::chrono::steady_clock::now();
+        std::map<int, std::vector<Show>> loaded = loadShowsForTheaters(missing);
+        auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 
-            // 3. WRITE BACK TO CACHE (TTL 5 mins)
-            redis->setSession(cache_key, json_arr.dump(), 300);
+        // 3. WRITE BACK: One pipelined batch (theaters without shows are cached as empty lists too)
+        std::vector<std::pair<std::string, std::string>> writes;
+        writes.reserve(missing.size());
+        auto* metrics = Metrics::GetInstance();
+        for (int id : missing) {
+            auto& shows = loaded[id];
+            writes.emplace_back(cacheKey(id), ShowCodec::encode(shows));
+            metrics->counter("catalog.refresh_count:" + metricKey(id, !shows.empty()))->fetch_add(1, std::memory_order_relaxed);
+            result[id] = std::move(shows);
+        }
+        redis->setManyWithMeta(writes, CACHE_TTL_SECONDS, elapsed_us / 1000.0);
+        metrics->histogram("catalog.batch_recompute_us")->record(elapsed_us);
+        return result;
+    }
 
-        } catch (const std::exception& e) {
-            std::cerr << "DB Error: " << e.what() << std::endl;
+private:
+    // One set-based query for every theater, rows grouped by theater_id
+    static std::map<int, std::vector<Show>> loadShowsForTheaters(const std::vector<int>& theater_ids) {
+        std::map<int, std::vector<Show>> shows;
+        DBConnection conn;
+        pqxx::work txn(*conn);
+        pqxx::result res = txn.exec_prepared(Statements::CATALOG_SHOWS_BATCH, Statements::intArray(theater_ids));
+        for (auto row : res) {
+            shows[row[0].as<int>()].push_back({
+                row[1].as<int>(), row[2].as<std::string>(),
+                row[3].as<std::string>(), row[4].as<double>()
+            });
+        }
+        return shows;
+    }
+
+    static std::vector<Show> loadShows(int theater_id) {
+        std::vector<Show> shows;
+        DBConnection conn;
+        pqxx::work txn(*conn);
+        // Complex Join: Show -> Movie
+        pqxx::result res = txn.exec_prepared(Statements::CATALOG_SHOWS, theater_id);
+        for (auto row : res) {
+            shows.push_back({
+                row[0].as<int>(), row[1].as<std::string>(), 
+                row[2].as<std::string>(), row[3].as<double>()
+            });
         }
         return shows;
     }
@@ -0,0 +1,123 @@
+#pragma once
+#include "../metrics/Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 🧺 GROUP-COMMIT WRITE COMBINER (generic)
+// Concurrent writers queue their item here and a few flusher threads drain up to max_batch
+// of them (or whatever arrived within max_wait_us of the first) into ONE call of `flush`,
+// which writes them in one transaction and returns one result per item. Results fan back
+// to the submitters via futures; if `flush` throws, every item in that batch gets the exception.
+//
+//   WriteCombiner<NewBooking, int> writer("booking.combiner", 64, 500, 2,
+//       [](std::vector<NewBooking>& batch) { return BookingDAO::createBookings(batch); });
+//   int id = writer.submit(booking).get();
+//
+// Records "<name>_batch_size" and "<name>_wait_us" (time spent queued before the flush).
+template <class Item, class Result>
+class WriteCombiner {
+public:
+    using Flush = std::function<std::vector<Result>(std::vector<Item>&)>;
+
+private:
+    struct Pending {
+        Item item;
+        std::promise<Result> result;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    const size_t max_batch_;
+    const std::chrono::microseconds max_wait_;
+    Flush flush_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+
+    LatencyHistogram* batch_size_;
+    LatencyHistogram* queue_wait_us_;
+
+    // Waits for work, then lingers until the batch is full or the first item is max_wait old
+    std::vector<Pending> nextBatch() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !queue_.empty(); });
+        auto deadline = queue_.front().enqueued + max_wait_;
+        cv_.wait_until(lock, deadline, [this] { return queue_.size() >= max_batch_; });
+
+        size_t n = std::min(queue_.size(), max_batch_);
+        std::vector<Pending> batch;
+        batch.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        bool more = !queue_.empty();
+        lock.unlock();
+        if (more) cv_.notify_one(); // Let another flusher start on the leftovers
+        return batch;
+    }
+
+    void flush(std::vector<Pending>& batch) {
+        auto now = std::chrono::steady_clock::now();
+        for (auto& p : batch) {
+            queue_wait_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(now - p.enqueued).count());
+        }
+        batch_size_->record((long long)batch.size());
+
+        std::vector<Item> items;
+        items.reserve(batch.size());
+        for (auto& p : batch) items.push_back(std::move(p.item));
+
+        try {
+            std::vector<Result> results = flush_(items);
+            for (size_t i = 0; i < batch.size(); i++) batch[i].result.set_value(results.at(i));
+        } catch (...) {
+            auto error = std::current_exception();
+            for (auto& p : batch) {
+                try { p.result.set_exception(error); }
+                catch (const std::future_error&) {} // Already answered before results.at() ran out
+            }
+        }
+    }
+
+    void run() {
+        while (true) {
+            auto batch = nextBatch();
+            if (!batch.empty()) flush(batch); // Empty if another flusher took it while we lingered
+        }
+    }
+
+public:
+    // Flusher threads run for the life of the process (owners are singletons)
+    WriteCombiner(const std::string& name, size_t max_batch, long long max_wait_us, int flushers, Flush flush)
+        : max_batch_(max_batch), max_wait_(max_wait_us), flush_(std::move(flush)),
+          batch_size_(Metrics::GetInstance()->histogram(name + "_batch_size")),
+          queue_wait_us_(Metrics::GetInstance()->histogram(name + "_wait_us")) {
+        for (int i = 0; i < flushers; i++) std::thread([this] { run(); }).detach();
+    }
+    WriteCombiner(const WriteCombiner&) = delete;
+    WriteCombiner& operator=(const WriteCombiner&) = delete;
+
+    std::future<Result> submit(Item item) {
+        Pending p{std::move(item), {}, std::chrono::steady_clock::now()};
+        std::future<Result> result = p.result.get_future();
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(p));
+            // First item wakes a flusher to start the linger timer; a full batch cuts it short
+            wake = queue_.size() == 1 || queue_.size() >= max_batch_;
+        }
+        if (wake) cv_.notify_one();
+        return result;
+    }
+};
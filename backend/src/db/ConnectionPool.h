@@ -0,0 +1,297 @@
+#pragma once
+#include "../metrics/Metrics.h"
+#include <pqxx/pqxx>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ⏳ Thrown when no connection frees up before the acquire deadline
+class PoolTimeoutError : public std::runtime_error {
+public:
+    explicit PoolTimeoutError(const std::string& pool)
+        : std::runtime_error("DB pool '" + pool + "' exhausted: acquire timed out") {}
+};
+
+// ⚙️ Pool sizing / healing knobs (fixed per pool; DBPool reads them from TM_DB_* at startup)
+struct PoolConfig {
+    int min_size = 2;
+    int max_size = 10;
+    std::chrono::milliseconds acquire_timeout{2000};
+    std::chrono::milliseconds grow_after{50};       // Wait this long on an empty pool before opening a new conn
+    std::chrono::seconds idle_timeout{60};          // Idle conns above min_size are closed after this
+    std::chrono::seconds health_interval{5};        // Maintenance tick: ping, reap, refill
+    std::function<void(pqxx::connection&)> on_connect; // Per-connection setup (prepared statements)
+};
+
+// 🏊 LOW-CONTENTION, SELF-HEALING CONNECTION POOL
+// Free connections live in N small shards instead of one queue behind one mutex.
+//   - Each thread has a home shard (hash of its id). It releases there and acquires
+//     from there first, LIFO, so it usually gets back the connection it just used.
+//   - If home is empty it tries the other shards with try_lock (never queues behind a peer).
+//   - Only when the whole pool is empty does it block, on a condition variable,
+//     up to a deadline, and then throws PoolTimeoutError instead of hanging forever.
+// Elastic + self-healing:
+//   - Broken connections are dropped on release; a background thread pings idle ones,
+//     reconnects up to min_size, and closes idle extras above min_size.
+//   - A waiter stuck longer than grow_after opens a new connection itself (up to max_size).
+// No logging on the hot path: wait times go into "db.<name>.acquire_wait_us".
+class ConnectionPool {
+public:
+    using ConnPtr = std::shared_ptr<pqxx::connection>;
+
+private:
+    struct Idle {
+        ConnPtr conn;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct alignas(64) Shard { // One cache line each, so shard locks don't false-share
+        std::mutex mutex;
+        std::vector<Idle> free;
+    };
+
+    std::string name_;
+    std::string conn_str_;
+    std::function<void(pqxx::connection&)> on_connect_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    const PoolConfig config_;
+    const int min_size_;
+    const int max_size_;
+
+    std::atomic<int> available_{0};
+    std::atomic<int> total_{0}; // Open connections: idle + borrowed + being opened
+    std::atomic<int> waiters_{0};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    LatencyHistogram* wait_us_;
+    std::atomic<long long>* timeouts_;
+    std::atomic<long long>* reconnects_;
+    std::atomic<long long>* dropped_;
+    std::atomic<long long>* grown_;
+    std::atomic<long long>* shrunk_;
+
+    size_t homeShard() const {
+        thread_local size_t home = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return home % shards_.size();
+    }
+
+    ConnPtr popFrom(Shard& shard) {
+        ConnPtr conn = std::move(shard.free.back().conn);
+        shard.free.pop_back();
+        available_.fetch_sub(1, std::memory_order_acq_rel);
+        return conn;
+    }
+
+    ConnPtr tryTake() {
+        if (available_.load(std::memory_order_acquire) <= 0) return nullptr;
+        size_t home = homeShard();
+        {
+            Shard& shard = *shards_[home];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.free.empty()) return popFrom(shard);
+        }
+        // Steal: skip any shard someone else is touching right now
+        for (size_t i = 1; i < shards_.size(); i++) {
+            Shard& shard = *shards_[(home + i) % shards_.size()];
+            std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+            if (lock.owns_lock() && !shard.free.empty()) return popFrom(shard);
+        }
+        return nullptr;
+    }
+
+    // Last resort: take the shard locks for real (a try_lock sweep can miss under heavy churn)
+    ConnPtr takeBlocking() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            if (!shard->free.empty()) return popFrom(*shard);
+        }
+        return nullptr;
+    }
+
+    void putBack(ConnPtr conn, size_t shard_index,
+                 std::chrono::steady_clock::time_point idle_since = std::chrono::steady_clock::now()) {
+        Shard& shard = *shards_[shard_index];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.free.push_back({std::move(conn), idle_since});
+        }
+        // seq_cst on both sides (here and in acquire) so a waiter and a releaser can't both miss each other
+        available_.fetch_add(1);
+        if (waiters_.load() > 0) {
+            std::lock_guard<std::mutex> lock(wait_mutex_); // Pairs with the waiter's check, no lost wakeups
+            wait_cv_.notify_one();
+        }
+    }
+
+    ConnPtr connect() {
+        auto conn = std::make_shared<pqxx::connection>(conn_str_);
+        if (!conn->is_open()) throw pqxx::broken_connection("connection not open");
+        if (on_connect_) on_connect_(*conn);
+        return conn;
+    }
+
+    // Reserve a slot below `limit` and open a connection in it. nullptr if full or connect fails.
+    ConnPtr tryGrow(int limit) {
+        int cur = total_.load();
+        do {
+            if (cur >= limit) return nullptr;
+        } while (!total_.compare_exchange_weak(cur, cur + 1));
+        try {
+            return connect();
+        } catch (...) {
+            total_.fetch_sub(1);
+            return nullptr;
+        }
+    }
+
+    // =========================================================
+    // MAINTENANCE: ping idle conns, reap extras, refill to min
+    // =========================================================
+    void maintain() {
+        auto now = std::chrono::steady_clock::now();
+        const PoolConfig& cfg = config();
+
+        for (size_t s = 0; s < shards_.size(); s++) {
+            // Check out the idle ones that need attention; recently used conns stay put
+            std::vector<Idle> check;
+            {
+                std::lock_guard<std::mutex> lock(shards_[s]->mutex);
+                auto& free = shards_[s]->free;
+                auto keep = std::stable_partition(free.begin(), free.end(), [&](const Idle& i) {
+                    return now - i.since < cfg.health_interval;
+                });
+                for (auto it = keep; it != free.end(); ++it) check.push_back(std::move(*it));
+                available_.fetch_sub((int)(free.end() - keep), std::memory_order_acq_rel);
+                free.erase(keep, free.end());
+            }
+            for (auto& idle : check) {
+                // 📉 Shrink: long-idle connections above the floor just go away
+                if (now - idle.since >= cfg.idle_timeout && total_.load() > min_size_) {
+                    total_.fetch_sub(1);
+                    shrunk_->fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                // 🩺 Health check
+                bool healthy = false;
+                try {
+                    pqxx::nontransaction ping(*idle.conn);
+                    ping.exec("SELECT 1");
+                    healthy = true;
+                } catch (...) {}
+                if (healthy) {
+                    putBack(std::move(idle.conn), s, idle.since); // A ping doesn't count as use
+                } else {
+                    total_.fetch_sub(1);
+                    dropped_->fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // 🔁 Reconnect up to the floor (stop at the first failure, retry next tick)
+        size_t opened = 0;
+        while (total_.load() < min_size_) {
+            ConnPtr conn = tryGrow(min_size_);
+            if (!conn) break;
+            putBack(std::move(conn), opened++ % shards_.size());
+            reconnects_->fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    ConnectionPool(std::string name, std::string conn_str, PoolConfig config)
+        : name_(std::move(name)), conn_str_(std::move(conn_str)), on_connect_(config.on_connect), config_(config),
+          min_size_(config.min_size), max_size_(config.max_size) {
+        auto* metrics = Metrics::GetInstance();
+        wait_us_ = metrics->histogram("db." + name_ + ".acquire_wait_us");
+        timeouts_ = metrics->counter("db." + name_ + ".acquire_timeouts");
+        reconnects_ = metrics->counter("db." + name_ + ".reconnects");
+        dropped_ = metrics->counter("db." + name_ + ".dropped");
+        grown_ = metrics->counter("db." + name_ + ".grown");
+        shrunk_ = metrics->counter("db." + name_ + ".shrunk");
+
+        size_t shard_count = std::max<size_t>(1, std::min<size_t>(config.max_size, std::max(1u, std::thread::hardware_concurrency())));
+        for (size_t i = 0; i < shard_count; i++) shards_.push_back(std::make_unique<Shard>());
+
+        // Failed opens are no longer lost: the maintenance thread keeps retrying up to min_size
+        for (int i = 0; i < config.min_size; ++i) {
+            ConnPtr conn = tryGrow(config.min_size);
+            if (conn) putBack(std::move(conn), i % shard_count);
+        }
+
+        std::thread([this] {
+            while (true) {
+                std::this_thread::sleep_for(this->config().health_interval);
+                try { maintain(); }
+                catch (const std::exception& e) { std::cerr << "⚠️ Pool '" << name_ << "' maintenance: " << e.what() << std::endl; }
+            }
+        }).detach();
+    }
+
+    const std::string& name() const { return name_; }
+    int available() const { return available_.load(std::memory_order_relaxed); }
+    int size() const { return total_.load(std::memory_order_relaxed); }
+
+    const PoolConfig& config() const { return config_; }
+
+    ConnPtr acquire() { return acquire(config().acquire_timeout); }
+
+    ConnPtr acquire(std::chrono::milliseconds timeout) {
+        auto start = std::chrono::steady_clock::now();
+
+        // ⚡ FAST PATH: home shard, then a non-blocking steal.
+        // Skipped while others are queued, so newcomers can't starve them.
+        ConnPtr conn = waiters_.load(std::memory_order_relaxed) == 0 ? tryTake() : nullptr;
+        if (!conn) {
+            // 🐢 SLOW PATH: pool is empty, wait for a release up to the deadline
+            auto deadline = start + timeout;
+            auto grow_at = start + config().grow_after;
+            waiters_.fetch_add(1);
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            while (!(conn = takeBlocking())) {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) break;
+                // 📈 Sustained pressure: open one more connection ourselves (outside the wait lock)
+                if (now >= grow_at && total_.load() < max_size_) {
+                    lock.unlock();
+                    conn = tryGrow(max_size_);
+                    lock.lock();
+                    if (conn) { grown_->fetch_add(1, std::memory_order_relaxed); break; }
+                    grow_at = now + config().grow_after; // Connect failed or raced: back off a bit
+                }
+                auto wake = total_.load() < max_size_ ? std::min(deadline, grow_at) : deadline;
+                wait_cv_.wait_until(lock, wake, [this] { return available_.load() > 0; });
+            }
+            lock.unlock();
+            waiters_.fetch_sub(1, std::memory_order_acq_rel);
+            if (!conn) {
+                timeouts_->fetch_add(1, std::memory_order_relaxed);
+                wait_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+                throw PoolTimeoutError(name_);
+            }
+        }
+        wait_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        return conn;
+    }
+
+    void release(ConnPtr conn) {
+        if (!conn) return;
+        // 🩹 Broken while borrowed (server restart, network blip): drop it
+        if (!conn->is_open()) {
+            total_.fetch_sub(1);
+            dropped_->fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        putBack(std::move(conn), homeShard());
+    }
+};
@@ -0,0 +1,247 @@
+#pragma once
+#include "../db.h"
+#include <libpq-fe.h>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/select.h>
+#endif
+
+// 🚰 LIBPQ PIPELINE MODE
+// pqxx sends one statement and waits for its answer before the next. For N independent
+// queries that is N round trips. In pipeline mode the client sends all N back to back and then
+// reads all N answers: one round trip, however many queries.
+//
+//   PipelineConnection conn(PoolType::REPLICA);
+//   PgPipeline p(conn.get());
+//   size_t a = p.add(Statements::CATALOG_SHOWS, 1);
+//   size_t b = p.add(Statements::CATALOG_SHOWS, 2);
+//   auto results = p.run();   // results[a], results[b]
+//
+// Each query gets its own sync point, so it runs in its own implicit transaction and a failing
+// query does not abort its neighbours. run() drains every answer before throwing, so the
+// connection is always reusable afterwards.
+//
+// ⏱️ A run has one overall deadline (RUN_TIMEOUT by default). The socket is only ever waited on
+// with select, never a blocking libpq call, so a stalled server turns into pqxx::broken_connection
+// and PipelineConnection closes the connection instead of pooling it.
+//
+// Pipelines run on pooled connections (see PipelineConnection), so the prepared statements are
+// the ones every pqxx connection registers on connect.
+
+// 📄 One query's result (text format), owns the PGresult
+class PgResult {
+    PGresult* res_ = nullptr;
+public:
+    explicit PgResult(PGresult* res) : res_(res) {}
+    PgResult(PgResult&& o) noexcept : res_(std::exchange(o.res_, nullptr)) {}
+    PgResult& operator=(PgResult&& o) noexcept { std::swap(res_, o.res_); return *this; }
+    PgResult(const PgResult&) = delete;
+    PgResult& operator=(const PgResult&) = delete;
+    ~PgResult() { if (res_) PQclear(res_); }
+
+    bool ok() const {
+        auto status = res_ ? PQresultStatus(res_) : PGRES_FATAL_ERROR;
+        return status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK;
+    }
+    std::string error() const { return res_ ? PQresultErrorMessage(res_) : "no result"; }
+
+    int size() const { return res_ ? PQntuples(res_) : 0; }
+    bool isNull(int row, int col) const { return PQgetisnull(res_, row, col); }
+    const char* get(int row, int col) const { return PQgetvalue(res_, row, col); }
+    std::string getString(int row, int col) const { return std::string(get(row, col), PQgetlength(res_, row, col)); }
+    int getInt(int row, int col) const { return std::atoi(get(row, col)); }
+    long long getLong(int row, int col) const { return std::atoll(get(row, col)); }
+    double getDouble(int row, int col) const { return std::atof(get(row, col)); }
+};
+
+class PgPipeline {
+public:
+    static constexpr std::chrono::milliseconds RUN_TIMEOUT{5000};
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Item {
+        std::string name;
+        std::vector<std::string> params;
+    };
+
+    PGconn* conn_;
+    std::chrono::milliseconds timeout_;
+    std::vector<Item> items_;
+
+    static std::string toParam(const std::string& v) { return v; }
+    static std::string toParam(const char* v) { return v; }
+    template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value>>
+    static std::string toParam(T v) { return std::to_string(v); }
+
+    // Waits for the socket until the run's deadline; past it the connection is given up on
+    void waitSocket(bool for_write, Clock::time_point deadline) {
+        int sock = PQsocket(conn_);
+        if (sock < 0) throw pqxx::broken_connection("pipeline: no socket");
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+        if (left <= 0) throw pqxx::broken_connection("pipeline: timed out");
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(sock, &rfds);
+        if (for_write) FD_SET(sock, &wfds);
+        timeval tv{(long)(left / 1000000), (long)(left % 1000000)};
+        int ready = select(sock + 1, &rfds, for_write ? &wfds : nullptr, nullptr, &tv);
+        if (ready < 0) throw pqxx::broken_connection("pipeline: select failed");
+        if (ready == 0) throw pqxx::broken_connection("pipeline: timed out");
+    }
+
+    // Reads until PQgetResult won't block, then returns its answer (NULL = end of this query's results)
+    PGresult* nextResult(Clock::time_point deadline) {
+        while (PQisBusy(conn_)) {
+            waitSocket(false, deadline);
+            if (!PQconsumeInput(conn_)) throw pqxx::broken_connection(std::string("pipeline read: ") + PQerrorMessage(conn_));
+        }
+        return PQgetResult(conn_);
+    }
+
+    void send(const Item& item) {
+        std::vector<const char*> values;
+        values.reserve(item.params.size());
+        for (const auto& p : item.params) values.push_back(p.c_str());
+        int sent = PQsendQueryPrepared(conn_, item.name.c_str(), (int)values.size(), values.data(), nullptr, nullptr, 0);
+        if (!sent) throw pqxx::broken_connection(std::string("pipeline send: ") + PQerrorMessage(conn_));
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    std::vector<PgResult> runPipelined() {
+        auto deadline = Clock::now() + timeout_;
+        if (!PQenterPipelineMode(conn_)) throw pqxx::broken_connection(std::string("pipeline mode: ") + PQerrorMessage(conn_));
+        PQsetnonblocking(conn_, 1); // So a big batch can't deadlock with the server writing answers back
+
+        for (const auto& item : items_) {
+            send(item);
+            if (!PQpipelineSync(conn_)) throw pqxx::broken_connection(std::string("pipeline sync: ") + PQerrorMessage(conn_));
+        }
+        // Push everything out, reading answers as they arrive so neither side's buffer fills up
+        while (true) {
+            int pending = PQflush(conn_);
+            if (pending == 0) break;
+            if (pending < 0) throw pqxx::broken_connection(std::string("pipeline flush: ") + PQerrorMessage(conn_));
+            waitSocket(true, deadline);
+            if (!PQconsumeInput(conn_)) throw pqxx::broken_connection(std::string("pipeline read: ") + PQerrorMessage(conn_));
+        }
+
+        // Answers come back in order: result, NULL, SYNC for each item
+        std::vector<PgResult> results;
+        results.reserve(items_.size());
+        size_t synced = 0;
+        bool have_result = false;
+        while (synced < items_.size()) {
+            PGresult* res = nextResult(deadline);
+            if (!res) {
+                if (PQstatus(conn_) != CONNECTION_OK) throw pqxx::broken_connection("pipeline: connection lost");
+                continue;
+            }
+            if (PQresultStatus(res) == PGRES_PIPELINE_SYNC) {
+                PQclear(res);
+                if (!have_result) results.emplace_back(nullptr);
+                synced++;
+                have_result = false;
+            } else if (!have_result) {
+                results.emplace_back(res);
+                have_result = true;
+            } else {
+                PQclear(res);
+            }
+        }
+        PQexitPipelineMode(conn_);
+        PQsetnonblocking(conn_, 0); // Back to what pqxx expects
+        return results;
+    }
+#endif
+
+    // Pre-14 libpq: same API, one round trip per query
+    // Still bounded by the run's deadline: a timeout leaves a query in flight, which makes the
+    // transaction status non-idle, so PipelineConnection closes the connection.
+    std::vector<PgResult> runSequential() {
+        auto deadline = Clock::now() + timeout_;
+        std::vector<PgResult> results;
+        results.reserve(items_.size());
+        for (const auto& item : items_) {
+            send(item);
+            PGresult* first = nextResult(deadline);
+            while (PGresult* extra = nextResult(deadline)) PQclear(extra);
+            results.emplace_back(first);
+        }
+        return results;
+    }
+
+public:
+    explicit PgPipeline(PGconn* conn, std::chrono::milliseconds timeout = RUN_TIMEOUT) : conn_(conn), timeout_(timeout) {}
+
+    // Queue a registered prepared statement (see Statements.h). Returns its index in run()'s results.
+    template <class... Args>
+    size_t add(const char* statement, const Args&... args) {
+        items_.push_back({statement, {toParam(args)...}});
+        return items_.size() - 1;
+    }
+
+    size_t size() const { return items_.size(); }
+
+    // Sends everything, collects every answer. Throws the first SQL error after draining.
+    std::vector<PgResult> run(bool throw_on_error = true) {
+        if (items_.empty()) return {};
+#ifdef LIBPQ_HAS_PIPELINING
+        std::vector<PgResult> results = runPipelined();
+#else
+        std::vector<PgResult> results = runSequential();
+#endif
+        items_.clear();
+        if (throw_on_error) {
+            for (size_t i = 0; i < results.size(); i++) {
+                if (!results[i].ok()) throw std::runtime_error("pipeline query " + std::to_string(i) + " failed: " + results[i].error());
+            }
+        }
+        return results;
+    }
+};
+
+// 🪄 RAII borrow from the regular ConnectionPool, routed exactly like DBConnection (replicas,
+// read-your-writes). Same limits, acquire deadline (PoolTimeoutError), wait histogram, health checks
+// and elasticity: for the length of the borrow the pqxx connection hands over its PGconn, and takes
+// it back on release.
+class PipelineConnection {
+    ConnectionPool* pool_;
+    ConnectionPool::ConnPtr conn_;
+    PGconn* raw_;
+public:
+    PipelineConnection(PoolType type = PoolType::REPLICA, uint64_t min_lsn = 0)
+        : pool_(&DBPool::GetInstance()->route(type, min_lsn)), conn_(pool_->acquire()) {
+        raw_ = std::move(*conn_).release_raw_connection();
+    }
+    ~PipelineConnection() {
+        // 🩹 Dead, or left mid-pipeline / mid-transaction by an exception: close it. The emptied
+        // pqxx connection is no longer open, so the pool drops that slot and refills it later.
+        bool broken = PQstatus(raw_) != CONNECTION_OK || PQtransactionStatus(raw_) != PQTRANS_IDLE;
+#ifdef LIBPQ_HAS_PIPELINING
+        broken = broken || PQpipelineStatus(raw_) != PQ_PIPELINE_OFF;
+#endif
+        if (broken) {
+            PQfinish(raw_);
+        } else {
+            try { *conn_ = pqxx::connection::seize_raw_connection(raw_); }
+            catch (...) { PQfinish(raw_); }
+        }
+        pool_->release(conn_);
+    }
+    PipelineConnection(const PipelineConnection&) = delete;
+    PipelineConnection& operator=(const PipelineConnection&) = delete;
+
+    PGconn* get() { return raw_; }
+    const std::string& source() const { return pool_->name(); } // "master", "replica0", ...
+};
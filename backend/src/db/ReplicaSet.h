@@ -0,0 +1,155 @@
+#pragma once
+#include "ConnectionPool.h"
+#include "Statements.h"
+#include "../metrics/Metrics.h"
+#include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 🔖 WAL positions ("16/B374D848") as one comparable integer
+namespace Lsn {
+    inline uint64_t parse(const std::string& text) {
+        unsigned int hi = 0, lo = 0;
+        if (std::sscanf(text.c_str(), "%X/%X", &hi, &lo) != 2) return 0;
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    inline std::string format(uint64_t lsn) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%X/%X", (unsigned int)(lsn >> 32), (unsigned int)(lsn & 0xFFFFFFFF));
+        return buf;
+    }
+}
+
+// 🪞 READ REPLICAS WITH LAG TRACKING
+// One pool per replica endpoint. A monitor thread asks each replica how far it has replayed
+// (pg_last_wal_replay_lsn) and the master how far it has written, once a second.
+// Reads round-robin over healthy replicas; a read that must see a given write (read-your-writes)
+// only goes to a replica whose replay position has reached that write's LSN, else to master.
+//
+// In the single-node setup the one "replica" is the master itself, so it is never behind.
+// Anywhere else an endpoint that is not in recovery (standalone, or promoted after a failover)
+// is not replaying the master's WAL, so it is marked unhealthy and never picked. A replica that
+// hasn't replayed anything yet (NULL replay LSN) only serves reads without an LSN floor.
+class ReplicaSet {
+private:
+    struct Replica {
+        std::unique_ptr<ConnectionPool> pool;
+        std::atomic<uint64_t> replay_lsn{0};
+        std::atomic<bool> healthy{false}; // Until the first successful poll
+        std::atomic<long long>* lag_bytes;
+        bool is_master = false; // Single-node: this endpoint IS the master
+    };
+
+    static constexpr uint64_t NEVER_BEHIND = std::numeric_limits<uint64_t>::max();
+
+    ConnectionPool& master_;
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    std::atomic<size_t> next_{0};
+    std::atomic<uint64_t> master_lsn_{0};
+    std::atomic<long long>* fallbacks_ = Metrics::GetInstance()->counter("db.read_fallback_master");
+
+    void pollMaster() {
+        auto conn = master_.acquire(std::chrono::milliseconds(500));
+        try {
+            pqxx::nontransaction txn(*conn);
+            noteMasterLsn(Lsn::parse(txn.exec_prepared(Statements::MASTER_WAL_LSN)[0][0].as<std::string>()));
+        } catch (...) {
+            master_.release(conn);
+            throw;
+        }
+        master_.release(conn);
+    }
+
+    void pollReplica(Replica& r) {
+        try {
+            auto conn = r.pool->acquire(std::chrono::milliseconds(500));
+            try {
+                pqxx::nontransaction txn(*conn);
+                auto row = txn.exec_prepared(Statements::REPLICA_REPLAY_LSN)[0];
+                bool in_recovery = row[0].as<bool>();
+                if (!in_recovery && !r.is_master) throw std::runtime_error("not in recovery (standalone or promoted)");
+                if (!in_recovery) r.replay_lsn = NEVER_BEHIND;
+                else r.replay_lsn = row[1].is_null() ? 0 : Lsn::parse(row[1].as<std::string>());
+            } catch (...) {
+                r.pool->release(conn);
+                throw;
+            }
+            r.pool->release(conn);
+            r.healthy = true;
+        } catch (const std::exception& e) {
+            if (r.healthy.exchange(false)) {
+                std::cerr << "⚠️ Replica '" << r.pool->name() << "' unhealthy: " << e.what() << std::endl;
+            }
+            return;
+        }
+        uint64_t replay = r.replay_lsn.load(), master = master_lsn_.load();
+        r.lag_bytes->store(replay >= master ? 0 : (long long)(master - replay), std::memory_order_relaxed);
+    }
+
+public:
+    // single_node: conn_strs is just the master's own endpoint (no replicas configured)
+    ReplicaSet(ConnectionPool& master, const std::vector<std::string>& conn_strs, const PoolConfig& config, bool single_node = false)
+        : master_(master) {
+        for (size_t i = 0; i < conn_strs.size(); i++) {
+            auto r = std::make_unique<Replica>();
+            std::string name = "replica" + std::to_string(i);
+            r->pool = std::make_unique<ConnectionPool>(name, conn_strs[i], config);
+            r->lag_bytes = Metrics::GetInstance()->counter("db." + name + ".lag_bytes");
+            r->is_master = single_node;
+            replicas_.push_back(std::move(r));
+        }
+        poll();
+    }
+
+    size_t size() const { return replicas_.size(); }
+    ConnectionPool& replica(size_t i) { return *replicas_[i]->pool; }
+    uint64_t replayLsn(size_t i) const { return replicas_[i]->replay_lsn.load(); }
+    bool healthy(size_t i) const { return replicas_[i]->healthy.load(); }
+
+    // Round-robin over healthy replicas that have replayed at least min_lsn; master if none qualify
+    ConnectionPool& pick(uint64_t min_lsn = 0) {
+        size_t n = replicas_.size();
+        size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t k = 0; k < n; k++) {
+            Replica& r = *replicas_[(start + k) % n];
+            if (r.healthy.load(std::memory_order_relaxed) && r.replay_lsn.load(std::memory_order_relaxed) >= min_lsn) {
+                return *r.pool;
+            }
+        }
+        fallbacks_->fetch_add(1, std::memory_order_relaxed);
+        return master_;
+    }
+
+    // Highest master WAL position we know has been written (monotonic)
+    void noteMasterLsn(uint64_t lsn) {
+        uint64_t seen = master_lsn_.load();
+        while (lsn > seen && !master_lsn_.compare_exchange_weak(seen, lsn)) {}
+    }
+    uint64_t masterLsn() const { return master_lsn_.load(); }
+
+    // One measurement round
+    void poll() {
+        try { pollMaster(); }
+        catch (const std::exception& e) { std::cerr << "⚠️ Master LSN poll failed: " << e.what() << std::endl; }
+        for (auto& r : replicas_) pollReplica(*r);
+    }
+
+    void start(std::chrono::milliseconds every = std::chrono::milliseconds(1000)) {
+        std::thread([this, every] {
+            while (true) {
+                std::this_thread::sleep_for(every);
+                poll();
+            }
+        }).detach();
+    }
+};
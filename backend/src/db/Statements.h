@@ -0,0 +1,168 @@
+#pragma once
+#include <pqxx/pqxx>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 📜 PREPARED STATEMENT REGISTRY
+// Every hot query lives here once. The pool prepares all of them on each connection
+// as it is opened, so Postgres parses and plans each statement once per connection
+// instead of once per request. Call sites use txn.exec_prepared(Statements::X, args...).
+namespace Statements {
+
+    // --- Seats ---
+    constexpr const char* SEAT_MAP = "seat_map";
+    constexpr const char* SEAT_IDS = "seat_ids";
+
+    // --- Bookings ---
+    constexpr const char* BOOKING_INSERT = "booking_insert";
+    constexpr const char* BOOKING_WITH_SEATS = "booking_with_seats";
+    constexpr const char* BOOKING_BY_KEY = "booking_by_key";
+    constexpr const char* BOOKINGS_BY_USER = "bookings_by_user";
+    constexpr const char* BOOKING_SUMMARY_BY_USER = "booking_summary_by_user";
+    constexpr const char* BOOKING_COUNT_BY_USER = "booking_count_by_user";
+
+    // --- Auth ---
+    constexpr const char* USER_INSERT = "user_insert";
+    constexpr const char* LOGIN_LOOKUP = "login_lookup";
+
+    // --- Catalog ---
+    constexpr const char* CATALOG_SHOWS = "catalog_shows";
+    constexpr const char* CATALOG_SHOWS_BATCH = "catalog_shows_batch";
+    constexpr const char* CATALOG_INDEX_DELTA = "catalog_index_delta";
+
+    // --- Availability ---
+    constexpr const char* AVAILABILITY_COUNTS = "availability_counts";
+
+    // --- Outbox ---
+    constexpr const char* OUTBOX_INSERT = "outbox_insert";
+    constexpr const char* OUTBOX_CLAIM = "outbox_claim";
+    constexpr const char* OUTBOX_DELETE = "outbox_delete";
+    constexpr const char* OUTBOX_RELEASE = "outbox_release";
+    constexpr const char* OUTBOX_LAG = "outbox_lag";
+
+    // --- Replication ---
+    constexpr const char* MASTER_WAL_LSN = "master_wal_lsn";
+    constexpr const char* REPLICA_REPLAY_LSN = "replica_replay_lsn";
+
+    // Postgres array literal for ANY($1::int[]) / unnest($1::int[]): {1,2,3}
+    template <class Int>
+    inline std::string intArray(const std::vector<Int>& values) {
+        std::string out = "{";
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i) out += ",";
+            out += std::to_string(values[i]);
+        }
+        out += "}";
+        return out;
+    }
+
+    // Postgres array literal for unnest($1::text[]): {"a","b \"quoted\""}
+    inline std::string textArray(const std::vector<std::string>& values) {
+        std::string out = "{";
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i) out += ",";
+            out += '"';
+            for (char c : values[i]) {
+                if (c == '"' || c == '\\') out += '\\';
+                out += c;
+            }
+            out += '"';
+        }
+        out += "}";
+        return out;
+    }
+
+    struct Statement {
+        const char* name;
+        const char* sql;
+    };
+
+    inline const std::vector<Statement>& all() {
+        static const std::vector<Statement> statements = {
+            {SEAT_MAP,
+             "SELECT s.id, CONCAT(s.row_code, s.seat_number), CASE WHEN b.status = 'CONFIRMED' THEN 'BOOKED' ELSE 'AVAILABLE' END "
+             "FROM screen_seats s LEFT JOIN booking_seats bs ON s.id = bs.screen_seat_id LEFT JOIN bookings b ON bs.booking_id = b.id "
+             "WHERE s.screen_id = $1 ORDER BY s.id ASC"},
+            {SEAT_IDS, "SELECT id FROM screen_seats"},
+
+            // $4 = idempotency key (NULL for none): a redelivered event inserts nothing and returns no rows
+            {BOOKING_INSERT,
+             "INSERT INTO bookings (user_id, show_id, status, total_amount, idempotency_key) VALUES ($1, $2, 'CONFIRMED', $3, $4) "
+             "ON CONFLICT (idempotency_key) DO NOTHING RETURNING id"},
+            // Booking row + every seat link in one statement; one RETURNING row per linked seat
+            {BOOKING_WITH_SEATS,
+             "WITH b AS (INSERT INTO bookings (user_id, show_id, status, total_amount, idempotency_key) "
+             "VALUES ($1, $2, 'CONFIRMED', $3, $5) ON CONFLICT (idempotency_key) DO NOTHING RETURNING id) "
+             "INSERT INTO booking_seats (booking_id, screen_seat_id) "
+             "SELECT b.id, seat FROM b, unnest($4::int[]) AS seat "
+             "RETURNING booking_id, screen_seat_id"},
+            {BOOKING_BY_KEY, "SELECT id FROM bookings WHERE idempotency_key = $1"},
+            // Keyset pages (index: bookings(user_id, id DESC)): $2 = cursor (ids below it), $3 = page size
+            {BOOKINGS_BY_USER,
+             "SELECT id, user_id, show_id, status, total_amount, booking_time FROM bookings "
+             "WHERE user_id = $1 AND id < $2 ORDER BY id DESC LIMIT $3"},
+            {BOOKING_SUMMARY_BY_USER,
+             "SELECT id, total_amount, status FROM bookings WHERE user_id = $1 AND id < $2 ORDER BY id DESC LIMIT $3"},
+            {BOOKING_COUNT_BY_USER, "SELECT COUNT(*) FROM bookings WHERE user_id = $1"},
+
+            {USER_INSERT, "INSERT INTO users (username, email, password_hash) VALUES ($1, $2, $3)"},
+            {LOGIN_LOOKUP, "SELECT password_hash FROM users WHERE email = $1"},
+
+            {CATALOG_SHOWS,
+             "SELECT s.id, m.title, s.start_time, s.price_standard "
+             "FROM shows s JOIN movies m ON s.movie_id = m.id "
+             "WHERE s.screen_id IN (SELECT id FROM screens WHERE theater_id = $1)"},
+            {CATALOG_SHOWS_BATCH,
+             "SELECT sc.theater_id, s.id, m.title, s.start_time, s.price_standard "
+             "FROM shows s JOIN movies m ON s.movie_id = m.id JOIN screens sc ON s.screen_id = sc.id "
+             "WHERE sc.theater_id = ANY($1::int[])"},
+            {CATALOG_INDEX_DELTA,
+             "SELECT s.id, t.city_id, sc.theater_id, s.screen_id, s.movie_id, m.title, "
+             "EXTRACT(EPOCH FROM s.start_time)::bigint, ROUND(s.price_standard * 100)::int "
+             "FROM shows s JOIN screens sc ON s.screen_id = sc.id "
+             "JOIN theaters t ON sc.theater_id = t.id JOIN movies m ON s.movie_id = m.id "
+             "WHERE s.id > $1 ORDER BY s.id"},
+
+            // Per show: seats in its screen, seats in confirmed bookings
+            {AVAILABILITY_COUNTS,
+             "SELECT s.id, "
+             "(SELECT COUNT(*) FROM screen_seats ss WHERE ss.screen_id = s.screen_id), "
+             "(SELECT COUNT(*) FROM bookings b JOIN booking_seats bs ON bs.booking_id = b.id "
+             " WHERE b.show_id = s.id AND b.status = 'CONFIRMED') "
+             "FROM shows s"},
+
+            // Many booking intents in one statement; the relay leases rows ($2 seconds) no other relay
+            // holds a live lease on, and commits before publishing (payloads are binary BookingEvents,
+            // hex-encoded on the way in and out)
+            {OUTBOX_INSERT, "INSERT INTO booking_outbox (payload) SELECT decode(h, 'hex') FROM unnest($1::text[]) AS h"},
+            {OUTBOX_CLAIM,
+             "UPDATE booking_outbox o SET claimed_until = now() + make_interval(secs => $2) FROM ("
+             "SELECT id FROM booking_outbox WHERE claimed_until IS NULL OR claimed_until < now() "
+             "ORDER BY id LIMIT $1 FOR UPDATE SKIP LOCKED) c WHERE o.id = c.id "
+             "RETURNING o.id, encode(o.payload, 'hex'), (EXTRACT(EPOCH FROM now() - o.created_at) * 1000)::bigint"},
+            {OUTBOX_DELETE, "DELETE FROM booking_outbox WHERE id = ANY($1::bigint[])"},
+            {OUTBOX_RELEASE, "UPDATE booking_outbox SET claimed_until = NULL WHERE id = ANY($1::bigint[])"},
+            // Rows not relayed yet, and how long the oldest has waited (ms)
+            {OUTBOX_LAG,
+             "SELECT COUNT(*), COALESCE((EXTRACT(EPOCH FROM now() - MIN(created_at)) * 1000)::bigint, 0) FROM booking_outbox"},
+
+            {MASTER_WAL_LSN, "SELECT pg_current_wal_lsn()::text"},
+            {REPLICA_REPLAY_LSN, "SELECT pg_is_in_recovery(), pg_last_wal_replay_lsn()::text"},
+        };
+        return statements;
+    }
+
+    // Hooked into ConnectionPool: runs once per new connection.
+    // A statement that fails to prepare (e.g. schema drift) only breaks its own call sites,
+    // not the whole connection.
+    inline void prepareAll(pqxx::connection& conn) {
+        for (const auto& statement : all()) {
+            try {
+                conn.prepare(statement.name, statement.sql);
+            } catch (const std::exception& e) {
+                std::cerr << "⚠️ Could not prepare '" << statement.name << "': " << e.what() << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "../dao/BookingDAO.h"
+#include "../codec/JsonWriter.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// 📦 STREAMED BOOKING EXPORT
+// A power user's full history can be tens of thousands of rows. Instead of one giant document,
+// the export walks the keyset pages (BookingDAO::forEachBookingPage) and appends each page's JSON
+// to a spool file, so a request only ever holds one page in memory. Crow then streams the file
+// to the client in chunks. Crow opens the file by path after the handler returns, so it can't be
+// unlinked up front; instead the sweeper thread deletes spool files older than SPOOL_TTL, whether
+// or not another export ever runs.
+class BookingExport {
+public:
+    static constexpr int PAGE_SIZE = 1000;
+    static constexpr std::chrono::minutes SPOOL_TTL{10};
+    static constexpr std::chrono::minutes SWEEP_EVERY{1};
+
+private:
+    static std::filesystem::path spoolDir() {
+        auto dir = std::filesystem::temp_directory_path() / "tm_exports";
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    // Old exports that have certainly finished downloading
+    static void sweep(const std::filesystem::path& dir) {
+        std::error_code ec;
+        auto cutoff = std::filesystem::file_time_type::clock::now() - SPOOL_TTL;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.last_write_time(ec) < cutoff) std::filesystem::remove(entry.path(), ec);
+        }
+    }
+
+public:
+    // Background loop deleting finished exports; call once at startup (later calls are no-ops)
+    static void startSweeper() {
+        static std::atomic<bool> running{false};
+        if (running.exchange(true)) return;
+        std::thread([] {
+            while (true) {
+                std::this_thread::sleep_for(SWEEP_EVERY);
+                try {
+                    sweep(spoolDir());
+                } catch (const std::exception& e) {
+                    std::cerr << "⚠️ Export spool sweep failed: " << e.what() << std::endl;
+                }
+            }
+        }).detach();
+    }
+
+    // Writes the user's bookings as a JSON array, newest first. Returns the spool file path.
+    static std::string spool(int user_id, uint64_t min_lsn = 0) {
+        auto dir = spoolDir();
+        sweep(dir);
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        auto path = dir / ("bookings-" + std::to_string(user_id) + "-" + std::to_string(rng()) + ".json");
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("cannot open export spool file");
+        std::string chunk;
+        JsonWriter w(chunk); // Commas carry over between pages; only the bytes are flushed
+        w.beginArray();
+        file << chunk;
+        try {
+            BookingDAO::forEachBookingPage(user_id, PAGE_SIZE, min_lsn, [&](const std::vector<Booking>& page) {
+                chunk.clear();
+                for (const auto& b : page) b.writeJson(w);
+                file << chunk;
+                return (bool)file;
+            });
+            chunk.clear();
+            w.endArray();
+            file << chunk;
+            file.close();
+            if (!file) throw std::runtime_error("export spool write failed");
+        } catch (...) {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            throw;
+        }
+        return path.string();
+    }
+};
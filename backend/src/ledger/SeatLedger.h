@@ -0,0 +1,321 @@
+#pragma once
+#include "../codec/SeatEvent.h"
+#include "../codec/Wire.h"
+#include "../messaging/MmapLog.h"
+#include "../metrics/Metrics.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 📒 SEAT LEDGER (event-sourced seat state, one per server)
+// Seat state otherwise lives in three places: Redis lock keys (holds), RabbitMQ/outbox (paid,
+// in flight) and Postgres (booked). After a restart the only way back was the AVAILABILITY_COUNTS
+// join, and the holds were simply lost. The ledger records every seat event this server applies
+// (its own and other servers', via the availability channel) in an embedded MmapLog:
+//
+//   RESERVED -> PAID -> CONFIRMED            (RELEASED / EXPIRED drop a hold at any point)
+//
+// and folds them into an in-memory map of every non-available seat. A snapshot of that map
+// (plus the per-show totals from the last reconcile) is written every SNAPSHOT_EVERY events or
+// SNAPSHOT_INTERVAL, tagged with the log offset it covers; once it is safely renamed into
+// place, the offset is committed so log retention can drop the segments behind it.
+//
+// Recovery = load the snapshot, replay the log from its offset. Events are applied as "set this
+// seat's state", so replaying one twice is harmless.
+//
+//   snapshot.bin : "TMSN" | u8 version | 3 pad | u64 log_offset | u32 shows | u64 seats
+//                  | shows x (i32 show_id, i32 total) | seats x (i32 show, i32 seat, u8 state, i64 expires_ms)
+//                  | u32 crc32(everything before)
+class SeatLedger {
+public:
+    enum class State : uint8_t { HELD = 1, PAID = 2, BOOKED = 3 }; // Available seats aren't stored
+
+    struct Seat {
+        int show_id;
+        int seat_id;
+        State state;
+        int64_t expires_ms; // Wall clock; 0 for BOOKED
+    };
+
+    struct Options {
+        std::filesystem::path dir;
+        size_t snapshot_every = 1000000;               // Events between snapshots (0: only snapshot())
+        std::chrono::seconds snapshot_interval{300};   // ...or this long, if anything happened
+        size_t segment_bytes = 64u << 20;
+
+        // TM_LEDGER_DIR, TM_LEDGER_SNAPSHOT_EVENTS, TM_LEDGER_SNAPSHOT_S
+        static Options fromEnv() {
+            auto env = [](const char* name) { const char* v = std::getenv(name); return v ? std::atoll(v) : 0LL; };
+            Options o;
+            const char* dir = std::getenv("TM_LEDGER_DIR");
+            o.dir = dir ? std::filesystem::path(dir) : std::filesystem::temp_directory_path() / "tm_seat_ledger";
+            if (env("TM_LEDGER_SNAPSHOT_EVENTS") > 0) o.snapshot_every = (size_t)env("TM_LEDGER_SNAPSHOT_EVENTS");
+            if (env("TM_LEDGER_SNAPSHOT_S") > 0) o.snapshot_interval = std::chrono::seconds(env("TM_LEDGER_SNAPSHOT_S"));
+            return o;
+        }
+    };
+
+    struct RecoveryStats {
+        size_t snapshot_seats = 0;
+        size_t replayed = 0;
+        long long snapshot_ms = 0;
+        long long replay_ms = 0;
+    };
+
+private:
+    struct Entry {
+        State state;
+        int64_t expires_ms;
+    };
+
+    static constexpr char SNAPSHOT_MAGIC[4] = {'T', 'M', 'S', 'N'};
+    static constexpr uint8_t SNAPSHOT_VERSION = 1;
+    static constexpr size_t SNAPSHOT_HEADER = 4 + 4 + 8 + 4 + 8;
+    static constexpr size_t SNAPSHOT_SHOW = 4 + 4;
+    static constexpr size_t SNAPSHOT_SEAT = 4 + 4 + 1 + 8;
+
+    Options opts_;
+    LogFormat::Options log_opts_;
+    MmapLog* log_;                        // Lives for the whole process, like every MmapLog
+    std::unique_ptr<LogReader> snapshots_; // Replays the tail; its committed offset = last snapshot
+
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> seats_; // (show << 32 | seat) -> state
+    std::unordered_map<int, int> totals_;
+    size_t since_snapshot_ = 0;
+    std::condition_variable snapshot_cv_;
+    std::mutex snapshot_mutex_; // One snapshot at a time
+    std::atomic<bool> running_{false};
+    RecoveryStats recovery_;
+
+    std::atomic<long long>* events_ = Metrics::GetInstance()->counter("ledger.events");
+    std::atomic<long long>* snapshots_taken_ = Metrics::GetInstance()->counter("ledger.snapshots");
+    LatencyHistogram* snapshot_ms_ = Metrics::GetInstance()->histogram("ledger.snapshot_ms");
+
+    static uint64_t key(int show_id, int seat_id) { return ((uint64_t)(uint32_t)show_id << 32) | (uint32_t)seat_id; }
+
+    static int64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::filesystem::path snapshotPath() const { return opts_.dir / "snapshot.bin"; }
+
+    // Under mutex_. BOOKED is final: a late hold event for a booked seat changes nothing.
+    void apply(const SeatEvent::Event& e) {
+        uint64_t k = key(e.show_id, e.seat_id);
+        auto it = seats_.find(k);
+        bool booked = it != seats_.end() && it->second.state == State::BOOKED;
+        switch (e.type) {
+            case SeatEvent::Type::RESERVED:
+                if (booked) break;
+                if (it == seats_.end()) seats_.emplace(k, Entry{State::HELD, e.expires_ms});
+                else it->second.expires_ms = e.expires_ms; // Extension; a PAID seat stays PAID
+                break;
+            case SeatEvent::Type::PAID:
+                if (booked) break;
+                if (it == seats_.end()) seats_.emplace(k, Entry{State::PAID, e.expires_ms});
+                else {
+                    it->second.state = State::PAID;
+                    if (e.expires_ms) it->second.expires_ms = e.expires_ms;
+                }
+                break;
+            case SeatEvent::Type::CONFIRMED:
+                seats_[k] = Entry{State::BOOKED, 0};
+                break;
+            case SeatEvent::Type::RELEASED:
+            case SeatEvent::Type::EXPIRED:
+                if (it != seats_.end() && !booked) seats_.erase(it);
+                break;
+        }
+    }
+
+    // Returns the log offset to replay from: the snapshot's, or the oldest kept if there is none
+    uint64_t loadSnapshot() {
+        std::ifstream in(snapshotPath(), std::ios::binary);
+        if (!in) return LogFormat::firstOffset(log_opts_);
+        std::string data((size_t)std::filesystem::file_size(snapshotPath()), '\0');
+        in.read(data.data(), (std::streamsize)data.size());
+        if (!in) data.clear(); // Fails the checks below
+
+        using namespace Wire;
+        const unsigned char* p = (const unsigned char*)data.data();
+        bool ok = data.size() >= SNAPSHOT_HEADER + 4 && std::memcmp(p, SNAPSHOT_MAGIC, 4) == 0 && p[4] == SNAPSHOT_VERSION &&
+                  LogFormat::crc32(data.data(), data.size() - 4) == getU32(p + data.size() - 4);
+        uint64_t offset = ok ? getU64(p + 8) : 0;
+        uint64_t shows = ok ? getU32(p + 16) : 0, seats = ok ? getU64(p + 20) : 0;
+        if (ok && data.size() != SNAPSHOT_HEADER + shows * SNAPSHOT_SHOW + seats * SNAPSHOT_SEAT + 4) ok = false;
+        if (!ok) {
+            std::cerr << "⚠️ Seat ledger snapshot is damaged, replaying the whole log" << std::endl;
+            return LogFormat::firstOffset(log_opts_);
+        }
+
+        p += SNAPSHOT_HEADER;
+        for (uint64_t i = 0; i < shows; i++, p += SNAPSHOT_SHOW) totals_[(int)getU32(p)] = (int)getU32(p + 4);
+        seats_.reserve((size_t)seats);
+        for (uint64_t i = 0; i < seats; i++, p += SNAPSHOT_SEAT) {
+            seats_.emplace(key((int)getU32(p), (int)getU32(p + 4)), Entry{(State)p[8], (int64_t)getU64(p + 9)});
+        }
+        recovery_.snapshot_seats = (size_t)seats;
+        return offset;
+    }
+
+    void recover() {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t from = loadSnapshot();
+        auto loaded = std::chrono::steady_clock::now();
+        snapshots_->seek(from);
+        SeatEvent::Event e;
+        recovery_.replayed = snapshots_->scan([&](std::string_view body, uint64_t) {
+            if (SeatEvent::decode(body, e)) apply(e);
+        });
+        // Holds that lapsed while we were down: no EXPIRED event will ever come for them
+        int64_t now = nowMs();
+        for (auto it = seats_.begin(); it != seats_.end();) {
+            if (it->second.state != State::BOOKED && it->second.expires_ms <= now) it = seats_.erase(it);
+            else ++it;
+        }
+        auto done = std::chrono::steady_clock::now();
+        recovery_.snapshot_ms = std::chrono::duration_cast<std::chrono::milliseconds>(loaded - start).count();
+        recovery_.replay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(done - loaded).count();
+        std::cout << "📒 Seat ledger: " << recovery_.snapshot_seats << " seats from snapshot (" << recovery_.snapshot_ms << "ms) + "
+                  << recovery_.replayed << " events replayed (" << recovery_.replay_ms << "ms)" << std::endl;
+    }
+
+    void runSnapshots() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                snapshot_cv_.wait_for(lock, opts_.snapshot_interval,
+                                      [this] { return opts_.snapshot_every > 0 && since_snapshot_ >= opts_.snapshot_every; });
+                if (since_snapshot_ == 0) continue; // Nothing new since the last one
+            }
+            try {
+                snapshot();
+            } catch (const std::exception& e) {
+                std::cerr << "⚠️ Seat ledger snapshot failed: " << e.what() << std::endl;
+            }
+        }
+    }
+
+public:
+    explicit SeatLedger(Options opts = Options::fromEnv()) : opts_(std::move(opts)) {
+        log_opts_.name = "ledger";
+        log_opts_.dir = opts_.dir;
+        log_opts_.segment_bytes = opts_.segment_bytes;
+        log_ = new MmapLog(log_opts_);
+        snapshots_ = std::make_unique<LogReader>("snapshot", log_opts_);
+        recover();
+    }
+    SeatLedger(const SeatLedger&) = delete;
+    SeatLedger& operator=(const SeatLedger&) = delete;
+
+    // Background snapshots (SNAPSHOT_EVERY / SNAPSHOT_INTERVAL)
+    void start() {
+        if (running_.exchange(true)) return;
+        std::thread([this] { runSnapshots(); }).detach();
+    }
+
+    // Applies the event now; it reaches disk with the log's next fsync batch
+    void record(SeatEvent::Type type, int show_id, int seat_id, int64_t expires_ms = 0) {
+        SeatEvent::Event e{type, show_id, seat_id, nowMs(), expires_ms};
+        std::string body = SeatEvent::encode(e);
+        bool due;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            apply(e);
+            log_->append(body); // Under mutex_: log order == apply order
+            due = opts_.snapshot_every > 0 && ++since_snapshot_ == opts_.snapshot_every;
+        }
+        events_->fetch_add(1, std::memory_order_relaxed);
+        if (due) snapshot_cv_.notify_one();
+    }
+
+    // Per-show seat totals (from ShowAvailability's reconcile), carried in the next snapshot
+    void setTotals(std::unordered_map<int, int> totals) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        totals_ = std::move(totals);
+    }
+
+    // Blocks until every recorded event is on disk
+    void sync() { log_->barrier().second.get(); }
+
+    void snapshot() {
+        std::lock_guard<std::mutex> one(snapshot_mutex_);
+        auto start = std::chrono::steady_clock::now();
+        std::string data;
+        std::pair<uint64_t, std::future<bool>> covered;
+        {
+            // Serialize under the lock (a flat copy of the map, no allocation per seat)
+            std::lock_guard<std::mutex> lock(mutex_);
+            covered = log_->barrier();
+            data.reserve(SNAPSHOT_HEADER + totals_.size() * SNAPSHOT_SHOW + seats_.size() * SNAPSHOT_SEAT + 4);
+            Wire::put(data, SNAPSHOT_MAGIC, 4);
+            data.push_back((char)SNAPSHOT_VERSION);
+            data.append(3, '\0');
+            Wire::putU64(data, covered.first);
+            Wire::putU32(data, (uint32_t)totals_.size());
+            Wire::putU64(data, seats_.size());
+            for (const auto& [show_id, total] : totals_) {
+                Wire::putU32(data, (uint32_t)show_id);
+                Wire::putU32(data, (uint32_t)total);
+            }
+            for (const auto& [k, entry] : seats_) {
+                Wire::putU32(data, (uint32_t)(k >> 32));
+                Wire::putU32(data, (uint32_t)k);
+                data.push_back((char)entry.state);
+                Wire::putU64(data, (uint64_t)entry.expires_ms);
+            }
+            since_snapshot_ = 0;
+        }
+        Wire::putU32(data, LogFormat::crc32(data.data(), data.size()));
+        covered.second.get(); // The snapshot must never claim events the log could still lose
+
+        auto tmp = opts_.dir / "snapshot.tmp";
+        std::error_code ec;
+        std::filesystem::remove(tmp, ec);
+        {
+            MappedFile out(tmp.string(), data.size());
+            std::memcpy(out.data(), data.data(), data.size());
+            out.flush(0, data.size());
+        }
+        std::filesystem::rename(tmp, snapshotPath()); // Atomic replace: a crash leaves the old or the new one
+        snapshots_->commit(covered.first);            // Retention may now drop what's behind it
+
+        snapshots_taken_->fetch_add(1, std::memory_order_relaxed);
+        snapshot_ms_->record(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // =========================================================
+    // READS (recovery seeding, benchmarks)
+    // =========================================================
+    std::vector<Seat> seats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Seat> out;
+        out.reserve(seats_.size());
+        for (const auto& [k, entry] : seats_) out.push_back({(int)(k >> 32), (int)(uint32_t)k, entry.state, entry.expires_ms});
+        return out;
+    }
+
+    std::unordered_map<int, int> totals() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return totals_;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return seats_.size();
+    }
+
+    const RecoveryStats& recovery() const { return recovery_; }
+};
@@ -1,15 +1,28 @@
 #include "crow.h"
 #include "db.h"
+#include "db/PgPipeline.h"
 #include "redis_manager.h"
 #include "BloomFilter.h"
 #include "middleware/Idempotency.h"
 #include "middleware/RateLimit.h"
 #include "dao/CatalogDAO.h"
 #include "dao/BookingDAO.h" 
-#include <SimpleAmqpClient/SimpleAmqpClient.h> 
+#include "export/BookingExport.h"
+#include "cache/RefreshAhead.h"
+#include "cache/ResponseCache.h"
+#include "catalog/CatalogIndex.h"
+#include "catalog/Availability.h"
+#include "metrics/Metrics.h"
+#include "outbox/BookingOutbox.h"
+#include "outbox/Backpressure.h"
+#include "outbox/IntentStatus.h"
+#include "codec/BookingEvent.h"
+#include "codec/JsonReader.h"
+#include "codec/JsonWriter.h"
 #include <mutex> // 👈 REQUIRED FOR THREAD SAFETY
-
-AmqpClient::Channel::ptr_t rabbit_channel;
+#include <algorithm>
+#include <charconv>
+#include <limits>
 
 // 🛡️ GLOBAL BLOOM FILTER
 BloomFilter* seatShield = nullptr;
@@ -17,15 +30,41 @@ BloomFilter* seatShield = nullptr;
 // 🛡️ GLOBAL REDIS MUTEX (Prevents Crashes)
 std::mutex redis_access_mutex; 
 
-void setupRabbitMQ() {
-    try {
-        std::cout << "🐰 Connecting to RabbitMQ..." << std::endl;
-        rabbit_channel = AmqpClient::Channel::Create("127.0.0.1");
-        rabbit_channel->DeclareQueue("bookings", false, true, false, false);
-        std::cout << "✅ Connected!" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "⚠️ RabbitMQ Warning: " << e.what() << std::endl;
-    }
+// 🏷️ LOCAL RESPONSE CACHE WINDOWS (how long a node answers 304s on its own)
+const long long CATALOG_LOCAL_TTL_MS = 2000;
+const long long SEATS_LOCAL_TTL_MS = 1000;
+const size_t MAX_BATCH_THEATERS = 100;
+const size_t MAX_AVAILABILITY_SHOWS = 500;
+
+// 🎫 SEAT HOLDS
+const int DEFAULT_SHOW_ID = 1;   // Until the frontend sends show_id
+const int SEAT_HOLD_TTL_S = 120;
+const int64_t SEAT_PRICE_CENTS = 5000; // Flat price until pricing lands
+const size_t MAX_SEAT_BODY = 4096;       // /api/reserve and /api/pay bodies are a few dozen bytes
+const size_t MAX_SEATS_PER_REQUEST = 50;
+
+// 🔖 READ-YOUR-WRITES: a user's latest commit LSN, kept with their session for a while
+// (written by booking_consumer after it commits)
+const std::string SESSION_LSN_PREFIX = "rw:lsn:user:";
+
+// 🔢 My-bookings total, computed on the first page only and kept as "<lsn> <count>":
+// reusable while the user has no commit newer than <lsn>
+const std::string BOOKING_COUNT_PREFIX = "bookings:count:user:";
+const int BOOKING_COUNT_TTL_S = 60;
+
+// 🐰 Booking queue drained by booking_consumer (RabbitMQ queue name; TM_BOOKING_QUEUE=log uses the embedded log)
+const std::string BOOKING_QUEUE = "bookings";
+
+void setupBookingQueue() {
+    std::cout << "🐰 Starting outbox relay..." << std::endl;
+    // RabbitMQ (reconnects on its own thread) or the embedded log; the outbox absorbs outages either way
+    BookingOutbox::GetInstance()->startRelay(BOOKING_QUEUE);
+    BookingBackpressure::GetInstance()->start(BookingOutbox::GetInstance()->queue());
+}
+
+void setupIntentStatus() {
+    std::cout << "🧾 Listening for booking completions..." << std::endl;
+    IntentStatus::GetInstance()->start();
 }
 
 void setupBloomFilter() {
@@ -33,7 +72,7 @@ void setupBloomFilter() {
     try {
         DBConnection conn(PoolType::REPLICA);
         pqxx::work txn(*conn);
-        pqxx::result res = txn.exec("SELECT id FROM screen_seats");
+        pqxx::result res = txn.exec_prepared(Statements::SEAT_IDS);
         
         seatShield = new BloomFilter(res.size() + 1000, 0.001);
         for (auto row : res) {
@@ -46,13 +85,128 @@ void setupBloomFilter() {
     }
 }
 
+void setupCatalogIndex() {
+    std::cout << "🗂️ BUILDING CATALOG INDEX..." << std::endl;
+    try {
+        auto* index = CatalogIndex::GetInstance();
+        index->rebuild();
+        std::cout << "🗂️ INDEX READY: " << index->snapshot()->by_city_movie_time.size() << " shows resident in RAM.\n";
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Catalog Index Init Failed: " << e.what() << std::endl;
+    }
+    CatalogIndex::GetInstance()->start(); // Keeps retrying / pulling deltas in the background
+}
+
+void setupAvailability() {
+    std::cout << "🎫 LOADING SEAT AVAILABILITY..." << std::endl;
+    auto* availability = ShowAvailability::GetInstance();
+    SeatLedger* ledger = nullptr;
+    try {
+        ledger = new SeatLedger(); // Snapshot + log tail (TM_LEDGER_DIR)
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Seat Ledger Init Failed: " << e.what() << std::endl;
+    }
+    // 📒 Seeded from the ledger: Postgres is reconciled in the background instead of blocking startup
+    if (!ledger || !availability->attachLedger(ledger)) {
+        try {
+            availability->reconcile();
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Availability Init Failed: " << e.what() << std::endl;
+        }
+    }
+    availability->start(); // Seat events + expiry sweep + periodic reconcile
+    if (ledger) ledger->start();
+}
+
 void add_cors_headers(crow::response& res) {
     res.add_header("Access-Control-Allow-Origin", "*");
     res.add_header("Access-Control-Allow-Methods", "GET, POST, PATCH, PUT, DELETE, OPTIONS");
-    res.add_header("Access-Control-Allow-Headers", "Origin, Content-Type, Accept, Authorization, X-Requested-With, Idempotency-Key");
+    res.add_header("Access-Control-Allow-Headers", "Origin, Content-Type, Accept, Authorization, X-Requested-With, Idempotency-Key, If-None-Match, X-Session-LSN");
     res.add_header("Access-Control-Max-Age", "3600");
 }
 
+// ✍️ JSON body (usually JsonWriter::threadBuffer()); the response takes its own copy
+crow::response json_response(int code, const std::string& body) {
+    auto res = crow::response(code, body);
+    res.add_header("Content-Type", "application/json");
+    add_cors_headers(res);
+    return res;
+}
+
+// ⏳ Pool exhausted past its deadline: tell the client to back off instead of hanging
+crow::response pool_busy_response() {
+    auto res = crow::response(503, "Database Busy");
+    res.add_header("Retry-After", "1");
+    add_cors_headers(res);
+    return res;
+}
+
+// 🔖 Read-your-writes floor for this user's reads: X-Session-LSN header or the one saved at booking time
+uint64_t session_lsn(const crow::request& req, RedisManager* redis) {
+    uint64_t min_lsn = Lsn::parse(req.get_header_value("X-Session-LSN"));
+    std::lock_guard<std::mutex> lock(redis_access_mutex);
+    if (auto token = redis->getSession(SESSION_LSN_PREFIX + "1")) min_lsn = std::max(min_lsn, Lsn::parse(*token));
+    return min_lsn;
+}
+
+// 🎟️ Seat selection for /api/reserve and /api/pay: {"show_id": 1, "seat_id": 5} or {"seat_ids": [5, 6, 7]}
+// Read straight off the body (JsonReader, no DOM). False for anything oversized, malformed or
+// mistyped, when no seat is named, and when a seat is named twice (it would be charged twice
+// and break the booking_seats key).
+struct SeatSelection {
+    int show_id = DEFAULT_SHOW_ID;
+    std::vector<int> seat_ids;
+};
+
+bool parse_seat_selection(const std::string& body, SeatSelection& out) {
+    static std::atomic<long long>* rejected = Metrics::GetInstance()->counter("requests.body_rejected");
+    bool ok = body.size() <= MAX_SEAT_BODY &&
+        JsonReader::forEachField(body, [&out](std::string_view key, JsonReader::Value& v) {
+            if (key == "show_id") return v.asInt(out.show_id);
+            if (key == "seat_ids") { out.seat_ids.clear(); return v.asIntArray(out.seat_ids, MAX_SEATS_PER_REQUEST); }
+            if (key == "seat_id") {
+                int seat;
+                if (!v.asInt(seat)) return false;
+                if (out.seat_ids.empty()) out.seat_ids.push_back(seat); // seat_ids wins when both are sent
+                return true;
+            }
+            return true;
+        });
+    if (ok) {
+        std::vector<int> sorted = out.seat_ids;
+        std::sort(sorted.begin(), sorted.end());
+        ok = std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+    }
+    if (!ok || out.seat_ids.empty()) {
+        rejected->fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// 🔑 Holds are per show: the same screen seat is free again at the next showing, and /api/pay
+// only finds the hold under the show it was reserved for
+std::string seat_hold_key(int show_id, int seat_id) {
+    return "seat:" + std::to_string(show_id) + ":" + std::to_string(seat_id);
+}
+
+// 🚦 Consumer lagging: stretch these seats' holds so they outlast the queue (no-op when it isn't)
+void extend_holds(RedisManager* redis, const BookingEvent::Event& event) {
+    auto* backpressure = BookingBackpressure::GetInstance();
+    int ttl = backpressure->holdTtl(SEAT_HOLD_TTL_S);
+    if (ttl <= SEAT_HOLD_TTL_S) return;
+    std::vector<std::string> keys;
+    for (int seat : event.seat_ids) keys.push_back(seat_hold_key(event.show_id, seat));
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(redis_access_mutex);
+        ok = redis->extendLocks(keys, ttl);
+    }
+    if (!ok) return;
+    for (int seat : event.seat_ids) ShowAvailability::publishHold(event.show_id, seat, ttl);
+    backpressure->recordExtended(keys.size());
+}
+
 std::string generateToken() {
     static const char alphanum[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     std::string tmp_s;
@@ -67,8 +221,12 @@ int main(int argc, char* argv[])
     crow::App<RateLimitMiddleware> app; 
     
     auto* redis = RedisManager::GetInstance();
-    setupRabbitMQ();
+    setupBookingQueue();
     setupBloomFilter();
+    setupCatalogIndex();
+    setupAvailability();
+    setupIntentStatus();
+    BookingExport::startSweeper(); // Deletes finished history exports
 
     std::cout << "\n🚀 TICKETMASTER BACKEND: READY (Bloom + CQRS + RabbitMQ + StampedeGuard)\n";
 
@@ -82,10 +240,11 @@ int main(int argc, char* argv[])
         if (!x) return crow::response(400, "Invalid JSON");
         try {
             DBConnection conn(PoolType::MASTER); pqxx::work txn(*conn);
-            txn.exec_params("INSERT INTO users (username, email, password_hash) VALUES ($1, $2, $3)", 
+            txn.exec_prepared(Statements::USER_INSERT, 
                 std::string(x["username"].s()), std::string(x["email"].s()), std::string(x["password"].s()));
             txn.commit();
             auto res = crow::response(201, "User Registered!"); add_cors_headers(res); return res;
+        } catch (const PoolTimeoutError&) { return pool_busy_response();
         } catch (const std::exception& ex) { return crow::response(500, ex.what()); }
     });
 
@@ -95,16 +254,18 @@ int main(int argc, char* argv[])
         if(!x) return crow::response(400);
         try {
             DBConnection conn(PoolType::REPLICA); pqxx::work txn(*conn);
-            pqxx::result res_db = txn.exec_params("SELECT password_hash FROM users WHERE email = $1", std::string(x["email"].s()));
+            pqxx::result res_db = txn.exec_prepared(Statements::LOGIN_LOOKUP, std::string(x["email"].s()));
             if (!res_db.empty() && std::string(x["password"].s()) == res_db[0][0].c_str()) {
                 std::string token = generateToken();
                 // Redis is thread-safe here because setSession inside RedisManager uses its own connection or is simple enough, 
                 // BUT for high safety we could lock, though login volume is usually lower than catalog.
                 RedisManager::GetInstance()->setSession(token, std::string(x["email"].s()), 3600);
-                crow::json::wvalue response; response["token"] = token;
-                auto res = crow::response(200, response); add_cors_headers(res); return res;
+                std::string& body = JsonWriter::threadBuffer();
+                JsonWriter(body).beginObject().field("token", token).endObject();
+                return json_response(200, body);
             }
             return crow::response(401, "Invalid Credentials");
+        } catch (const PoolTimeoutError&) { return pool_busy_response();
         } catch (...) { return crow::response(500); }
     });
 
@@ -112,50 +273,96 @@ int main(int argc, char* argv[])
     CROW_ROUTE(app, "/api/profile").methods(crow::HTTPMethod::GET)([redis](const crow::request& req){
         std::string token = req.get_header_value("Authorization");
         auto email = redis->getSession(token);
-        if (email) { crow::json::wvalue response; response["user"] = *email; auto res = crow::response(200, response); add_cors_headers(res); return res; }
+        if (email) {
+            std::string& body = JsonWriter::threadBuffer();
+            JsonWriter(body).beginObject().field("user", *email).endObject();
+            return json_response(200, body);
+        }
         return crow::response(403);
     });
 
-    // 4. GET SEATS
+    // 4. GET SEATS (micro-cached: ETag/304 + precompressed variants)
     CROW_ROUTE(app, "/api/seats").methods(crow::HTTPMethod::GET)([](const crow::request& req){
+        const std::string cache_key = "seats:screen:1";
+        auto* responses = ResponseCache::GetInstance();
+        if (auto entry = responses->get(cache_key)) {
+            auto res = ResponseCache::respond(req, *entry); add_cors_headers(res); return res;
+        }
         try {
             DBConnection conn(PoolType::REPLICA); pqxx::work txn(*conn);
-            std::string query = "SELECT s.id, CONCAT(s.row_code, s.seat_number), CASE WHEN b.status = 'CONFIRMED' THEN 'BOOKED' ELSE 'AVAILABLE' END FROM screen_seats s LEFT JOIN booking_seats bs ON s.id = bs.screen_seat_id LEFT JOIN bookings b ON bs.booking_id = b.id WHERE s.screen_id = 1 ORDER BY s.id ASC;";
-            pqxx::result res_db = txn.exec(query);
-            std::stringstream json; json << "[";
-            for (size_t i = 0; i < res_db.size(); ++i) {
-                json << "{\"id\": " << res_db[i][0] << ", \"label\": \"" << res_db[i][1] << "\", \"status\": \"" << res_db[i][2] << "\"}";
-                if (i < res_db.size() - 1) json << ",";
+            pqxx::result res_db = txn.exec_prepared(Statements::SEAT_MAP, 1);
+            std::string& body = JsonWriter::threadBuffer();
+            JsonWriter json(body);
+            json.beginArray();
+            for (const auto& row : res_db) {
+                // Labels come from row_code as-is, so they go through the escaper like any other string
+                json.beginObject()
+                    .field("id", row[0].as<int>())
+                    .field("label", std::string_view(row[1].c_str(), row[1].size()))
+                    .field("status", std::string_view(row[2].c_str(), row[2].size()))
+                    .endObject();
             }
-            json << "]";
-            auto res = crow::response(200, json.str()); res.add_header("Content-Type", "application/json"); add_cors_headers(res); return res; 
+            json.endArray();
+            // Seat status changes often, so keep this window short; the 304 still saves the bandwidth
+            auto entry = responses->put(cache_key, body, std::chrono::milliseconds(SEATS_LOCAL_TTL_MS));
+            auto res = ResponseCache::respond(req, *entry); add_cors_headers(res); return res; 
+        } catch (const PoolTimeoutError&) { return pool_busy_response();
         } catch (...) { return crow::response(500); }
     });
 
     // =========================================================
-    // 5. CATALOG CACHE (WITH STAMPEDE PROTECTION & THREAD SAFETY 🐘)
+    // 5. CATALOG CACHE (WITH STAMPEDE PROTECTION, REFRESH-AHEAD & THREAD SAFETY 🐘)
     // =========================================================
     CROW_ROUTE(app, "/api/theaters/<int>/shows").methods(crow::HTTPMethod::GET)
-    ([redis](int theater_id){
-        std::string key = "shows:theater:" + std::to_string(theater_id);
+    ([redis](const crow::request& req, int theater_id){
+        std::string key = CatalogDAO::cacheKey(theater_id);
         std::string lock_key = "lock:" + key;
+        auto* responses = ResponseCache::GetInstance();
+
+        // ⏩ XFETCH: Hot keys win this roll shortly before expiry and get rebuilt in the background
+        auto maybe_refresh_ahead = [&](double delta_ms, long long ttl_ms) {
+            if (!RefreshAhead::shouldRefreshEarly(delta_ms, ttl_ms)) return;
+            RefreshAhead::GetInstance()->schedule(key, [redis, theater_id, lock_key] {
+                // Same lock as the miss path, so only one node in the cluster recomputes
+                bool acquired = false;
+                {
+                    std::lock_guard<std::mutex> lock(redis_access_mutex);
+                    acquired = redis->acquireLockBulk({lock_key}, "refresher", 2);
+                }
+                if (acquired) CatalogDAO::refreshCache(theater_id);
+            });
+        };
+
+        // 🏷️ LOCAL HIT: 304 / precompressed body without touching Redis or Postgres.
+        // Hot keys are served from here almost every time, so this is where they roll the dice,
+        // against the Redis copy's remaining TTL as it stood when the entry was stored.
+        if (auto entry = responses->get(key)) {
+            if (entry->delta_ms > 0) {
+                auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(entry->source_expires_at - std::chrono::steady_clock::now()).count();
+                maybe_refresh_ahead(entry->delta_ms, remaining_ms);
+            }
+            auto r = ResponseCache::respond(req, *entry);
+            r.add_header("X-Source", "Local"); add_cors_headers(r); return r;
+        }
         
         for(int i=0; i<10; i++) { 
-            std::string cached_data = "";
-            bool is_cached = false;
+            std::optional<RedisManager::CacheEntry> cached;
             
             // 🔒 LOCK REDIS ACCESS
             {
                 std::lock_guard<std::mutex> lock(redis_access_mutex);
-                auto cached = redis->getSession(key);
-                if (cached) {
-                    cached_data = *cached;
-                    is_cached = true;
-                }
+                cached = redis->getWithMeta(key);
             } 
 
-            if (is_cached) { 
-                auto r = crow::response(200, cached_data); 
+            // Binary ShowCodec payload; anything we can't decode is treated as a miss
+            std::vector<Show> shows;
+            if (cached && ShowCodec::decode(cached->value, shows)) { 
+                maybe_refresh_ahead(cached->delta_ms, cached->ttl_ms);
+                // Never outlive the Redis copy, so other nodes' refreshes show up quickly
+                auto local_ttl = std::min<long long>(cached->ttl_ms, CATALOG_LOCAL_TTL_MS);
+                auto entry = responses->put(key, Show::toJsonArray(shows), std::chrono::milliseconds(local_ttl),
+                                            "application/json", cached->delta_ms, std::chrono::milliseconds(cached->ttl_ms));
+                auto r = ResponseCache::respond(req, *entry); 
                 r.add_header("X-Source", "Redis"); 
                 add_cors_headers(r); return r; 
             }
@@ -167,18 +374,15 @@ int main(int argc, char* argv[])
                 acquired = redis->acquireLockBulk({lock_key}, "loader", 2);
             }
 
-            if (true) {
+            if (acquired) {
                 std::cout << "🐘 STAMPEDE: I am the Chosen One! Refilling Cache...\n";
                 try {
-                    std::vector<Show> shows = CatalogDAO::getShows(theater_id);
-                    std::string json = "[{\"status\": \"Freshly Loaded from DB (Stampede Prevented)\"}]";
-                    
-                    // 🔒 LOCK REDIS ACCESS
-                    {
-                        std::lock_guard<std::mutex> lock(redis_access_mutex);
-                        redis->setSession(key, json, 30);
-                    }
-                    auto r = crow::response(200, json); r.add_header("X-Source", "Postgres"); add_cors_headers(r); return r;
+                    double delta_ms = 0;
+                    shows = CatalogDAO::refreshCache(theater_id, &delta_ms);
+                    auto entry = responses->put(key, Show::toJsonArray(shows), std::chrono::milliseconds(CATALOG_LOCAL_TTL_MS),
+                                                "application/json", delta_ms, std::chrono::seconds(CatalogDAO::CACHE_TTL_SECONDS));
+                    auto r = ResponseCache::respond(req, *entry); r.add_header("X-Source", "Postgres"); add_cors_headers(r); return r;
+                } catch (const PoolTimeoutError&) { return pool_busy_response();
                 } catch (const std::exception& e) { return crow::response(500, "DB Error"); }
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(200));
@@ -189,29 +393,39 @@ int main(int argc, char* argv[])
     // 6. RESERVE
     CROW_ROUTE(app, "/api/reserve").methods(crow::HTTPMethod::POST)
     ([redis](const crow::request& req){
-        auto x = crow::json::load(req.body);
-        if (!x) return crow::response(400);
+        SeatSelection selection;
+        if (!parse_seat_selection(req.body, selection)) { auto r = crow::response(400, "Invalid request"); add_cors_headers(r); return r; }
+        int show_id = selection.show_id;
 
-        int seat_id = -1;
-        if (x.has("seat_id")) seat_id = x["seat_id"].i();
-        else if (x.has("seat_ids")) seat_id = x["seat_ids"][0].i();
+        // 🗂️ Only real shows: a HOLD for a made-up show_id would create availability state forever
+        auto* catalog = CatalogIndex::GetInstance();
+        if (!catalog->loaded()) {
+            auto r = crow::response(503, "Catalog loading"); r.add_header("Retry-After", "5"); add_cors_headers(r); return r;
+        }
+        if (!catalog->hasShow(show_id)) { auto r = crow::response(404, "Unknown show"); add_cors_headers(r); return r; }
 
-        if (seatShield && !seatShield->possiblyContains(std::to_string(seat_id))) {
-            std::cout << "🛡️ BLOOM BLOCK: Seat " << seat_id << " is invalid.\n";
-            auto r = crow::response(404, "Invalid Seat"); add_cors_headers(r); return r;
+        std::vector<std::string> lock_keys;
+        for (int seat_id : selection.seat_ids) {
+            if (seatShield && !seatShield->possiblyContains(std::to_string(seat_id))) {
+                std::cout << "🛡️ BLOOM BLOCK: Seat " << seat_id << " is invalid.\n";
+                auto r = crow::response(404, "Invalid Seat"); add_cors_headers(r); return r;
+            }
+            lock_keys.push_back(seat_hold_key(show_id, seat_id));
         }
 
         std::string user_email = "User"; 
-        std::vector<std::string> lock_keys = {"seat:" + std::to_string(seat_id)};
         
-        // 🔒 LOCK REDIS ACCESS
+        // 🔒 LOCK REDIS ACCESS (all seats or none, so /api/pay finds the whole group held)
         bool success = false;
         {
             std::lock_guard<std::mutex> lock(redis_access_mutex);
-            success = redis->acquireLockBulk(lock_keys, user_email, 120);
+            success = redis->acquireLockBulk(lock_keys, user_email, SEAT_HOLD_TTL_S);
         }
 
-        if (success) { auto r = crow::response(200, "Reserved!"); add_cors_headers(r); return r; } 
+        if (success) {
+            for (int seat_id : selection.seat_ids) ShowAvailability::publishHold(show_id, seat_id, SEAT_HOLD_TTL_S);
+            auto r = crow::response(200, "Reserved!"); add_cors_headers(r); return r;
+        } 
         else { auto r = crow::response(409, "Seat taken"); add_cors_headers(r); return r; }
     });
 
@@ -221,51 +435,258 @@ int main(int argc, char* argv[])
         crow::response existing_res;
         if (IdempotencyManager::check(req, existing_res)) { add_cors_headers(existing_res); return existing_res; }
         
-        auto x = crow::json::load(req.body);
-        int seat_val = (int)x["seat_id"].i();
-        std::string seat_id = std::to_string(seat_val);
-        std::string lock_key = "seat:" + seat_id;
-        
-        std::optional<std::string> owner;
+        // 🎟️ One event for the whole group: {"seat_id": 5} or {"seat_ids": [5, 6, 7]}
+        SeatSelection selection;
+        if (!parse_seat_selection(req.body, selection)) { auto r = crow::response(400, "Invalid request"); add_cors_headers(r); return r; }
+        BookingEvent::Event event;
+        event.user_id = 1;
+        event.show_id = selection.show_id;
+        event.seat_ids = std::move(selection.seat_ids);
+
+        // Every seat must still be held for THIS show (reserve locks one key per show+seat),
+        // so a show_id that doesn't match the hold is refused like an expired one
         {
-             std::lock_guard<std::mutex> lock(redis_access_mutex);
-             owner = redis->getSession(lock_key);
+            std::lock_guard<std::mutex> lock(redis_access_mutex);
+            for (int seat : event.seat_ids) {
+                if (!redis->getSession(seat_hold_key(event.show_id, seat))) {
+                    auto r = crow::response(403, "Expired"); add_cors_headers(r); return r;
+                }
+            }
         }
 
-        if (!owner) return crow::response(403, "Expired"); 
+        // 🚦 Backlog too deep: keep the holds alive for the retry, but don't queue more behind it
+        auto* backpressure = BookingBackpressure::GetInstance();
+        if (!backpressure->admit()) {
+            extend_holds(redis, event);
+            auto r = crow::response(503, "Bookings backlogged, retry later");
+            r.add_header("Retry-After", std::to_string(backpressure->retryAfterSeconds()));
+            add_cors_headers(r); return r;
+        }
 
-        std::string response_body;
-        if (rabbit_channel) {
-            std::string msg = "BOOK " + seat_id + " 1"; 
-            rabbit_channel->BasicPublish("", "bookings", AmqpClient::BasicMessage::Create(msg));
-            response_body = "{\"status\": \"PROCESSING\"}";
-        } else {
-            BookingDAO::createBooking(1, 1, {seat_val}, 50.0);
-            response_body = "{\"status\": \"CONFIRMED\"}";
+        event.amount_cents = SEAT_PRICE_CENTS * (int64_t)event.seat_ids.size();
+        event.idempotency_key = req.get_header_value("Idempotency-Key");
+        if (event.idempotency_key.empty()) event.idempotency_key = generateToken();
+        event.created_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // 📤 Same path whether or not RabbitMQ is up: the event is committed to the outbox,
+        // the relay publishes it, booking_consumer books it.
+        if (!BookingOutbox::GetInstance()->append(BookingEvent::encode(event))) {
+            auto r = crow::response(503, "Booking unavailable"); add_cors_headers(r); return r;
         }
+        extend_holds(redis, event);
+        for (int seat : event.seat_ids) ShowAvailability::publishPaid(event.show_id, seat);
+        // 🧾 The idempotency key doubles as the intent id: GET /api/bookings/status?intent=<id>
+        IntentStatus::markProcessing(event.idempotency_key);
+        std::string& response_body = JsonWriter::threadBuffer();
+        JsonWriter(response_body).beginObject().field("status", "PROCESSING").field("intent_id", event.idempotency_key).endObject();
         IdempotencyManager::save(req, response_body);
-        auto r = crow::response(200, response_body); add_cors_headers(r); return r;
+        return json_response(200, response_body);
     });
 
-    // 8. MY BOOKINGS
-    CROW_ROUTE(app, "/api/my-bookings").methods(crow::HTTPMethod::GET)([](const crow::request& req){
+    // 8. MY BOOKINGS (keyset pages): /api/my-bookings?cursor=<X-Next-Cursor>&limit=50
+    CROW_ROUTE(app, "/api/my-bookings").methods(crow::HTTPMethod::GET)([redis](const crow::request& req){
+        uint64_t min_lsn = session_lsn(req, redis);
+        int cursor = BookingDAO::FIRST_PAGE;
+        int limit = BookingDAO::DEFAULT_PAGE_SIZE;
+        if (const char* c = req.url_params.get("cursor")) cursor = std::atoi(c);
+        if (const char* l = req.url_params.get("limit")) limit = BookingDAO::clampPage(std::atoi(l));
+        if (cursor <= 0) return crow::response(400, "Invalid cursor");
+
+        // X-Total-Count only on the first page, from Redis unless this user has booked since
+        bool first_page = req.url_params.get("cursor") == nullptr;
+        std::string count_key = BOOKING_COUNT_PREFIX + "1";
+        std::string total;
+        if (first_page) {
+            std::lock_guard<std::mutex> lock(redis_access_mutex);
+            if (auto cached = redis->getSession(count_key)) {
+                size_t space = cached->find(' ');
+                if (space != std::string::npos && Lsn::parse(cached->substr(0, space)) >= min_lsn) total = cached->substr(space + 1);
+            }
+        }
         try {
-            DBConnection conn(PoolType::REPLICA); pqxx::work txn(*conn);
-            pqxx::result res = txn.exec_params("SELECT id, total_amount, status FROM bookings WHERE user_id = 1 ORDER BY id DESC");
-            crow::json::wvalue json_arr;
-            int i = 0;
-            for (auto row : res) {
-                json_arr[i]["id"] = row[0].as<int>();
-                json_arr[i]["amount"] = row[1].as<double>();
-                json_arr[i]["status"] = row[2].as<std::string>();
-                i++;
+            // 🚰 Page (+ total when it isn't cached) in one pipelined round trip
+            PipelineConnection conn(PoolType::REPLICA, min_lsn);
+            PgPipeline pipeline(conn.get());
+            size_t list_q = pipeline.add(Statements::BOOKING_SUMMARY_BY_USER, 1, cursor, limit);
+            bool count = first_page && total.empty();
+            size_t count_q = count ? pipeline.add(Statements::BOOKING_COUNT_BY_USER, 1) : 0;
+            auto results = pipeline.run();
+            if (count) {
+                total = results[count_q].getString(0, 0);
+                std::lock_guard<std::mutex> lock(redis_access_mutex);
+                redis->setSession(count_key, Lsn::format(min_lsn) + " " + total, BOOKING_COUNT_TTL_S);
+            }
+            const PgResult& res = results[list_q];
+            std::string& body = JsonWriter::threadBuffer();
+            JsonWriter json(body);
+            json.beginArray();
+            for (int i = 0; i < res.size(); i++) {
+                json.beginObject()
+                    .field("id", res.getInt(i, 0))
+                    .field("amount", res.getDouble(i, 1))
+                    .field("status", res.getString(i, 2))
+                    .endObject();
             }
-            auto r = crow::response(200, json_arr); add_cors_headers(r); return r;
+            json.endArray();
+            auto r = json_response(200, body);
+            r.add_header("X-Read-Source", conn.source());
+            if (!total.empty()) r.add_header("X-Total-Count", total);
+            if (res.size() == limit) r.add_header("X-Next-Cursor", res.getString(limit - 1, 0)); // Absent on the last page
+            return r;
+        } catch (const PoolTimeoutError&) { return pool_busy_response();
         } catch (...) { return crow::response(500); }
     });
 
+    // 8b. FULL HISTORY EXPORT (streamed from a spool file, one page in memory at a time)
+    CROW_ROUTE(app, "/api/my-bookings/export").methods(crow::HTTPMethod::GET)([redis](const crow::request& req){
+        uint64_t min_lsn = session_lsn(req, redis);
+        try {
+            std::string path = BookingExport::spool(1, min_lsn);
+            crow::response r;
+            r.set_static_file_info_unsafe(path);
+            r.add_header("Content-Disposition", "attachment; filename=\"bookings.json\"");
+            add_cors_headers(r);
+            return r;
+        } catch (const PoolTimeoutError&) { return pool_busy_response();
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Export failed: " << e.what() << std::endl;
+            return crow::response(500);
+        }
+    });
+
+    // 9. METRICS (Refresh counts, recompute latency, ...)
+    CROW_ROUTE(app, "/api/metrics").methods(crow::HTTPMethod::GET)([](){
+        return json_response(200, Metrics::GetInstance()->toJson());
+    });
+
+    // 10. CATALOG BATCH (city pages): /api/shows?theater_ids=1,2,3
+    CROW_ROUTE(app, "/api/shows").methods(crow::HTTPMethod::GET)([](const crow::request& req){
+        const char* param = req.url_params.get("theater_ids");
+        if (!param) return crow::response(400, "theater_ids required");
+
+        std::vector<int> theater_ids;
+        std::stringstream ss(param);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            char* end = nullptr;
+            long id = std::strtol(item.c_str(), &end, 10);
+            if (item.empty() || *end != '\0' || id <= 0) return crow::response(400, "Invalid theater id");
+            if (std::find(theater_ids.begin(), theater_ids.end(), (int)id) == theater_ids.end()) theater_ids.push_back((int)id);
+        }
+        if (theater_ids.empty() || theater_ids.size() > MAX_BATCH_THEATERS) return crow::response(400, "Too many theater ids");
+
+        try {
+            size_t misses = 0;
+            auto listings = CatalogDAO::getShowsBatch(theater_ids, &misses);
+            std::string& body = JsonWriter::threadBuffer();
+            JsonWriter json(body);
+            json.beginObject();
+            char id_key[16];
+            for (const auto& [id, shows] : listings) {
+                auto end = std::to_chars(id_key, id_key + sizeof(id_key), id).ptr;
+                json.key(std::string_view(id_key, end - id_key));
+                Show::writeJsonArray(json, shows);
+            }
+            json.endObject();
+            auto r = json_response(200, body);
+            r.add_header("X-Cache-Misses", std::to_string(misses));
+            return r;
+        } catch (const PoolTimeoutError&) { return pool_busy_response();
+        } catch (const std::exception& e) { return crow::response(500, "DB Error"); }
+    });
+
+    // 11. CATALOG SEARCH (resident index, no SQL): /api/catalog/search?city=1&movie=2&from=<epoch>&to=<epoch>
+    //     or /api/catalog/search?theater=1&from=...&to=...   (movie is optional with city)
+    CROW_ROUTE(app, "/api/catalog/search").methods(crow::HTTPMethod::GET)([](const crow::request& req){
+        auto param = [&req](const char* name, long long fallback) {
+            const char* v = req.url_params.get(name);
+            return v ? std::atoll(v) : fallback;
+        };
+        long long city = param("city", 0), movie = param("movie", 0), theater = param("theater", 0);
+        long long from = param("from", 0), to = param("to", std::numeric_limits<int64_t>::max());
+        if (city <= 0 && theater <= 0) return crow::response(400, "city or theater required");
+
+        auto* index = CatalogIndex::GetInstance();
+        std::vector<ShowEntry> hits = theater > 0 ? index->findByTheater((int)theater, from, to)
+                                    : movie > 0   ? index->findByCityMovie((int)city, (int)movie, from, to)
+                                                  : index->findByCity((int)city, from, to);
+        auto snap = index->snapshot();
+        std::string& body = JsonWriter::threadBuffer();
+        JsonWriter json(body);
+        json.beginArray();
+        for (const auto& e : hits) {
+            auto title = snap->movie_titles.find(e.movie_id);
+            json.beginObject()
+                .field("id", e.show_id)
+                .field("movie_id", e.movie_id)
+                .field("movie", title != snap->movie_titles.end() ? std::string_view(title->second) : std::string_view())
+                .field("theater_id", e.theater_id)
+                .field("screen_id", e.screen_id)
+                .field("start", (long long)e.start_epoch)
+                .field("price", e.price_cents / 100.0)
+                .endObject();
+        }
+        json.endArray();
+        auto r = json_response(200, body);
+        r.add_header("X-Index-Version", std::to_string(snap->version));
+        return r;
+    });
+
+    // 12. SEATS LEFT (listing pages): /api/shows/availability?ids=1,2,3
+    CROW_ROUTE(app, "/api/shows/availability").methods(crow::HTTPMethod::GET)([](const crow::request& req){
+        const char* param = req.url_params.get("ids");
+        if (!param) return crow::response(400, "ids required");
+
+        std::vector<int> show_ids;
+        std::stringstream ss(param);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            char* end = nullptr;
+            long id = std::strtol(item.c_str(), &end, 10);
+            if (item.empty() || *end != '\0' || id <= 0) return crow::response(400, "Invalid show id");
+            show_ids.push_back((int)id);
+        }
+        if (show_ids.empty() || show_ids.size() > MAX_AVAILABILITY_SHOWS) return crow::response(400, "Too many show ids");
+
+        // Served straight from the in-memory counters: no DB, no Redis
+        std::string& body = JsonWriter::threadBuffer();
+        JsonWriter json(body);
+        json.beginObject();
+        char id_key[16];
+        for (const auto& s : ShowAvailability::GetInstance()->get(show_ids)) {
+            auto end = std::to_chars(id_key, id_key + sizeof(id_key), s.show_id).ptr;
+            json.key(std::string_view(id_key, end - id_key)).beginObject()
+                .field("total", s.total)
+                .field("held", s.held)
+                .field("booked", s.booked)
+                .field("available", s.available())
+                .endObject();
+        }
+        json.endObject();
+        return json_response(200, body);
+    });
+
+    // 13. BOOKING STATUS: /api/bookings/status?intent=<id>&wait=<seconds>
+    // wait=0 (default) answers from the status table at once; wait>0 long-polls until the
+    // consumer commits (pushed over Redis pub/sub) or the wait runs out, then returns the status.
+    CROW_ROUTE(app, "/api/bookings/status").methods(crow::HTTPMethod::GET)([](const crow::request& req){
+        const char* intent = req.url_params.get("intent");
+        if (!intent || !*intent) return crow::response(400, "intent required");
+        int wait = 0;
+        if (const char* w = req.url_params.get("wait")) wait = std::max(0, std::atoi(w));
+
+        auto status = IntentStatus::GetInstance()->await(intent, std::chrono::seconds(wait));
+        if (!status) { auto r = crow::response(404, "Unknown intent"); add_cors_headers(r); return r; }
+        auto r = crow::response(200, *status);
+        r.add_header("Content-Type", "application/json");
+        if (!IntentStatus::isFinal(*status)) r.add_header("Retry-After", "1");
+        add_cors_headers(r); return r;
+    });
+
     try {
-        app.bindaddr("127.0.0.1").port(port).multithreaded().run();
+        // Extra workers for parked status long-polls, so they never starve the other routes
+        unsigned int workers = std::max(1u, std::thread::hardware_concurrency()) + (unsigned int)IntentStatus::maxWaiters();
+        app.bindaddr("127.0.0.1").port(port).concurrency(workers).run();
     } catch (const std::exception& e) {
         std::cerr << "🔥 FATAL CRASH: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,65 @@
+#pragma once
+#include <SimpleAmqpClient/SimpleAmqpClient.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// 🔭 RABBITMQ QUEUE DEPTH
+// Publishing goes through AsyncPublisher's own connection, which only its thread may touch.
+// Backpressure still needs to ask the broker how deep the queue is, so that question goes over
+// one separate SimpleAmqpClient channel (a passive declare, a few times a second at most).
+//
+// The channel is opened on first use and dropped whenever a call throws (broker restart,
+// closed channel). After a failure no one waits on a connect for RETRY_AFTER.
+class AmqpQueueProbe {
+public:
+    static constexpr std::chrono::seconds RETRY_AFTER{2};
+
+private:
+    static AmqpQueueProbe* instance;
+    static std::mutex instance_mutex_;
+
+    std::string host_;
+    std::mutex mutex_; // An AMQP channel is not thread-safe
+    AmqpClient::Channel::ptr_t channel_;
+    std::atomic<long long> down_until_ms_{0};
+
+    AmqpQueueProbe() {
+        const char* host = std::getenv("TM_AMQP_HOST");
+        host_ = host ? host : "127.0.0.1";
+    }
+
+    static long long nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+public:
+    static AmqpQueueProbe* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new AmqpQueueProbe();
+        return instance;
+    }
+
+    // Messages waiting in `queue`; -1 if the broker can't be asked right now
+    long long depth(const std::string& queue) {
+        if (nowMs() < down_until_ms_.load(std::memory_order_relaxed)) return -1;
+        std::lock_guard<std::mutex> lock(mutex_);
+        try {
+            if (!channel_) channel_ = AmqpClient::Channel::Create(host_);
+            uint32_t messages = 0, consumers = 0;
+            channel_->DeclareQueueWithCounts(queue, messages, consumers, true, true, false, false);
+            return messages;
+        } catch (const std::exception& e) {
+            std::cerr << "⚠️ RabbitMQ queue depth: " << e.what() << std::endl;
+            channel_.reset();
+            down_until_ms_ = nowMs() + std::chrono::duration_cast<std::chrono::milliseconds>(RETRY_AFTER).count();
+            return -1;
+        }
+    }
+};
+
+AmqpQueueProbe* AmqpQueueProbe::instance = nullptr;
+std::mutex AmqpQueueProbe::instance_mutex_;
@@ -0,0 +1,347 @@
+#pragma once
+#include "AmqpQueueProbe.h"
+#include "BookingQueue.h"
+#include "../metrics/Metrics.h"
+#include <rabbitmq-c/amqp.h>
+#include <rabbitmq-c/tcp_socket.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+
+// 📮 ASYNC PUBLISHER WITH A CONFIRM WINDOW
+// A synchronous confirmed publish costs every /api/pay one broker round trip: publish, wait for the ack.
+// Here handlers only enqueue (lock-free, multi-producer) and get a future. One publisher
+// thread owns a raw rabbitmq-c connection in confirm mode and:
+//   - writes up to MAX_BATCH queued messages back to back, without waiting in between
+//   - keeps up to WINDOW of them unconfirmed at once (delivery tags 1, 2, 3, ...)
+//   - reads basic.ack / basic.nack as they come (usually multiple=true: one ack, many messages)
+//     and completes each message's future
+// So a burst of N payments shares one round trip instead of paying N.
+//
+// future.get() == true means the broker confirmed a persistent message on the durable queue.
+// false means it was nacked, returned (unroutable), or the connection dropped before the
+// ack; the outbox relay then keeps the row and retries it. A message "lost" that way may
+// still have reached the queue (at-least-once), exactly as with a synchronous publish that timed out.
+//
+// Nothing waits forever: a message unconfirmed after CONFIRM_TIMEOUT fails its whole window and
+// the connection is rebuilt (a broker blocking publishers on a memory/disk alarm, a half-open
+// link), socket writes time out after the same interval, and AMQP heartbeats (HEARTBEAT_S) let
+// either side notice a dead peer while idle.
+class AsyncPublisher : public BookingQueue {
+public:
+    static constexpr size_t MAX_BATCH = 256;  // Messages written per burst before reading acks
+    static constexpr size_t WINDOW = 4096;    // Unconfirmed messages in flight
+    static constexpr std::chrono::seconds RETRY_AFTER{2};
+    static constexpr std::chrono::seconds CONFIRM_TIMEOUT{10};
+    static constexpr int HEARTBEAT_S = 10;
+
+private:
+    static constexpr amqp_channel_t CHANNEL = 1;
+
+    struct Message {
+        std::atomic<Message*> next{nullptr};
+        std::string body;
+        std::promise<bool> confirmed;
+    };
+
+    // Vyukov's intrusive MPSC queue: producers swap the head, the publisher thread walks the tail
+    struct MpscQueue {
+        std::atomic<Message*> head;
+        Message* tail;
+        Message stub;
+
+        MpscQueue() : head(&stub), tail(&stub) {}
+
+        void push(Message* m) {
+            m->next.store(nullptr, std::memory_order_relaxed);
+            Message* prev = head.exchange(m, std::memory_order_acq_rel);
+            prev->next.store(m, std::memory_order_release);
+        }
+
+        // Consumer only. nullptr when empty (or a producer is mid-push; it shows up next call).
+        Message* pop() {
+            Message* t = tail;
+            Message* next = t->next.load(std::memory_order_acquire);
+            if (t == &stub) {
+                if (!next) return nullptr;
+                tail = next;
+                t = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (next) {
+                tail = next;
+                return t;
+            }
+            if (t != head.load(std::memory_order_acquire)) return nullptr;
+            push(&stub);
+            next = t->next.load(std::memory_order_acquire);
+            if (next) {
+                tail = next;
+                return t;
+            }
+            return nullptr;
+        }
+    };
+
+    struct InFlight {
+        uint64_t tag;
+        Message* message;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    std::string host_;
+    std::string queue_;
+    MpscQueue queue_in_;
+    std::atomic<size_t> queued_{0};
+
+    // Sleep/wake for the publisher thread when there's nothing to send or confirm
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> connected_{false};
+
+    // Publisher-thread state
+    amqp_connection_state_t conn_ = nullptr;
+    uint64_t next_tag_ = 0;
+    std::deque<InFlight> in_flight_; // Ascending tags
+    std::unordered_set<uint64_t> returned_;
+
+    std::atomic<long long>* published_ = Metrics::GetInstance()->counter("amqp.async.published");
+    std::atomic<long long>* failed_ = Metrics::GetInstance()->counter("amqp.async.failed");
+    std::atomic<long long>* reconnects_ = Metrics::GetInstance()->counter("amqp.async.reconnects");
+    std::atomic<long long>* timed_out_ = Metrics::GetInstance()->counter("amqp.async.confirm_timeouts");
+    LatencyHistogram* batch_size_ = Metrics::GetInstance()->histogram("amqp.async.batch_size");
+    LatencyHistogram* confirm_us_ = Metrics::GetInstance()->histogram("amqp.async.confirm_us");
+
+    static void check(amqp_rpc_reply_t reply, const char* what) {
+        if (reply.reply_type != AMQP_RESPONSE_NORMAL) throw std::runtime_error(std::string("AMQP ") + what + " failed");
+    }
+
+    static amqp_bytes_t bytes(const std::string& s) { return amqp_bytes_t{s.size(), (void*)s.data()}; }
+
+    void connect() {
+        conn_ = amqp_new_connection();
+        amqp_socket_t* socket = amqp_tcp_socket_new(conn_);
+        if (!socket || amqp_socket_open(socket, host_.c_str(), 5672) != AMQP_STATUS_OK) {
+            throw std::runtime_error("AMQP connect to " + host_ + " failed");
+        }
+        // A blocked broker stops reading: bound socket writes so send() can't hang the thread
+#ifdef _WIN32
+        DWORD send_timeout = (DWORD)std::chrono::milliseconds(CONFIRM_TIMEOUT).count();
+#else
+        timeval send_timeout{(long)CONFIRM_TIMEOUT.count(), 0};
+#endif
+        setsockopt(amqp_get_sockfd(conn_), SOL_SOCKET, SO_SNDTIMEO, (const char*)&send_timeout, sizeof(send_timeout));
+        timeval rpc_timeout{(long)CONFIRM_TIMEOUT.count(), 0}; // login, declares and the close handshake
+        amqp_set_rpc_timeout(conn_, &rpc_timeout);
+        check(amqp_login(conn_, "/", 0, 131072, HEARTBEAT_S, AMQP_SASL_METHOD_PLAIN, "guest", "guest"), "login");
+        amqp_channel_open(conn_, CHANNEL);
+        check(amqp_get_rpc_reply(conn_), "channel.open");
+        amqp_confirm_select(conn_, CHANNEL);
+        check(amqp_get_rpc_reply(conn_), "confirm.select");
+        amqp_queue_declare(conn_, CHANNEL, bytes(queue_), 0, 1, 0, 0, amqp_empty_table); // Durable
+        check(amqp_get_rpc_reply(conn_), "queue.declare");
+        next_tag_ = 0; // Tags restart per channel
+    }
+
+    void disconnect() {
+        if (!conn_) return;
+        amqp_connection_close(conn_, AMQP_REPLY_SUCCESS);
+        amqp_destroy_connection(conn_);
+        conn_ = nullptr;
+    }
+
+    void complete(Message* m, bool ok) {
+        m->confirmed.set_value(ok);
+        (ok ? published_ : failed_)->fetch_add(1, std::memory_order_relaxed);
+        delete m;
+    }
+
+    void send(Message* m) {
+        std::string tag = std::to_string(++next_tag_);
+        amqp_basic_properties_t props{};
+        props._flags = AMQP_BASIC_DELIVERY_MODE_FLAG | AMQP_BASIC_MESSAGE_ID_FLAG;
+        props.delivery_mode = AMQP_DELIVERY_PERSISTENT;
+        props.message_id = bytes(tag); // Lets a basic.return be matched to its delivery tag
+        in_flight_.push_back({next_tag_, m, std::chrono::steady_clock::now()}); // Owned by the window from here on
+        int rc = amqp_basic_publish(conn_, CHANNEL, amqp_empty_bytes, bytes(queue_), 1, 0, &props, bytes(m->body));
+        if (rc != AMQP_STATUS_OK) throw std::runtime_error(std::string("AMQP publish: ") + amqp_error_string2(rc));
+    }
+
+    // multiple: every in-flight message up to `tag`; otherwise just `tag`
+    void settle(uint64_t tag, bool multiple, bool ok) {
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = in_flight_.begin(); it != in_flight_.end() && it->tag <= tag;) {
+            if (!multiple && it->tag != tag) { ++it; continue; }
+            bool delivered = ok && !returned_.erase(it->tag);
+            confirm_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(now - it->sent).count());
+            complete(it->message, delivered);
+            it = in_flight_.erase(it);
+        }
+    }
+
+    // Read whatever confirms have arrived; waits up to `wait` for the first one. Polls the
+    // socket even with nothing in flight, which is what sends and checks heartbeats.
+    void readConfirms(std::chrono::microseconds wait) {
+        timeval tv{(long)(wait.count() / 1000000), (long)(wait.count() % 1000000)};
+        do {
+            amqp_frame_t frame;
+            int rc = amqp_simple_wait_frame_noblock(conn_, &frame, &tv);
+            if (rc == AMQP_STATUS_TIMEOUT) break;
+            if (rc != AMQP_STATUS_OK) throw std::runtime_error(std::string("AMQP read: ") + amqp_error_string2(rc));
+            tv = timeval{0, 0}; // Only the first read waits
+            if (frame.frame_type != AMQP_FRAME_METHOD) continue;
+
+            switch (frame.payload.method.id) {
+            case AMQP_BASIC_ACK_METHOD: {
+                auto* ack = (amqp_basic_ack_t*)frame.payload.method.decoded;
+                settle(ack->delivery_tag, ack->multiple, true);
+                break;
+            }
+            case AMQP_BASIC_NACK_METHOD: {
+                auto* nack = (amqp_basic_nack_t*)frame.payload.method.decoded;
+                settle(nack->delivery_tag, nack->multiple, false);
+                break;
+            }
+            case AMQP_BASIC_RETURN_METHOD: {
+                // mandatory + unroutable: the broker still acks it afterwards, remember it failed
+                amqp_message_t message;
+                check(amqp_read_message(conn_, frame.channel, &message, 0), "read returned message");
+                const auto& id = message.properties.message_id;
+                returned_.insert(std::strtoull(std::string((const char*)id.bytes, id.len).c_str(), nullptr, 10));
+                amqp_destroy_message(&message);
+                break;
+            }
+            case AMQP_CHANNEL_CLOSE_METHOD:
+            case AMQP_CONNECTION_CLOSE_METHOD:
+                throw std::runtime_error("AMQP channel closed by broker");
+            default:
+                break;
+            }
+        } while (!in_flight_.empty());
+        amqp_maybe_release_buffers(conn_);
+    }
+
+    // The oldest unconfirmed message has waited too long: treat the connection as dead
+    void checkDeadline() {
+        if (in_flight_.empty() || std::chrono::steady_clock::now() - in_flight_.front().sent < CONFIRM_TIMEOUT) return;
+        timed_out_->fetch_add(1, std::memory_order_relaxed);
+        throw std::runtime_error("no confirm within " + std::to_string(CONFIRM_TIMEOUT.count()) + "s");
+    }
+
+    // Connection lost: nothing in the window will ever be confirmed
+    void failInFlight() {
+        for (auto& f : in_flight_) complete(f.message, false);
+        in_flight_.clear();
+        returned_.clear();
+    }
+
+    void failQueued() {
+        while (Message* m = queue_in_.pop()) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            complete(m, false);
+        }
+    }
+
+    void sleepUntilWork(std::chrono::milliseconds max_wait) {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleeping_.store(true);
+        if (queued_.load() == 0) wake_cv_.wait_for(lock, max_wait);
+        sleeping_.store(false);
+    }
+
+    void run() {
+        auto retry_at = std::chrono::steady_clock::now();
+        while (true) {
+            if (!conn_) {
+                if (std::chrono::steady_clock::now() < retry_at) {
+                    failQueued(); // Broker down: callers fall back right away instead of queueing up
+                    sleepUntilWork(std::chrono::milliseconds(100));
+                    continue;
+                }
+                try {
+                    connect();
+                    connected_ = true;
+                    std::cout << "✅ Async publisher connected to " << host_ << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "⚠️ RabbitMQ Warning: " << e.what() << std::endl;
+                    disconnect();
+                    retry_at = std::chrono::steady_clock::now() + RETRY_AFTER;
+                    continue;
+                }
+            }
+
+            try {
+                // 📤 Burst: as many queued messages as the window allows
+                size_t sent = 0;
+                while (sent < MAX_BATCH && in_flight_.size() < WINDOW) {
+                    Message* m = queue_in_.pop();
+                    if (!m) break;
+                    queued_.fetch_sub(1, std::memory_order_relaxed);
+                    send(m);
+                    sent++;
+                }
+                if (sent) batch_size_->record(sent);
+
+                // 📥 Confirms: don't wait if there's more to send, wait a little if all we can do is wait
+                bool more = queued_.load(std::memory_order_relaxed) > 0 && in_flight_.size() < WINDOW;
+                readConfirms(more ? std::chrono::microseconds(0) : std::chrono::microseconds(2000));
+                checkDeadline();
+
+                if (in_flight_.empty() && queued_.load() == 0) sleepUntilWork(std::chrono::milliseconds(100));
+            } catch (const std::exception& e) {
+                std::cerr << "⚠️ Async publisher lost the broker: " << e.what() << " (" << in_flight_.size() << " unconfirmed)" << std::endl;
+                failInFlight();
+                disconnect();
+                connected_ = false;
+                reconnects_->fetch_add(1, std::memory_order_relaxed);
+                retry_at = std::chrono::steady_clock::now(); // One immediate retry (broker restarts), then back off
+            }
+        }
+    }
+
+public:
+    // Lives for the whole process (its thread is detached): allocate it, don't put it on the stack
+    AsyncPublisher(std::string queue, std::string host = "") : queue_(std::move(queue)) {
+        const char* env = std::getenv("TM_AMQP_HOST");
+        host_ = !host.empty() ? host : env ? env : "127.0.0.1";
+        std::thread([this] { run(); }).detach();
+    }
+    AsyncPublisher(const AsyncPublisher&) = delete;
+    AsyncPublisher& operator=(const AsyncPublisher&) = delete;
+
+    bool connected() const { return connected_.load(std::memory_order_relaxed); }
+    const char* transport() const override { return "amqp"; }
+
+    // Ready count of the queue, asked on a separate channel (never this thread's connection)
+    long long depth() override { return connected() ? AmqpQueueProbe::GetInstance()->depth(queue_) : -1; }
+
+    // Never blocks: the future completes when the broker confirms (true) or gives up (false)
+    std::future<bool> publish(std::string body) override {
+        auto* m = new Message();
+        m->body = std::move(body);
+        std::future<bool> confirmed = m->confirmed.get_future();
+        queued_.fetch_add(1);
+        queue_in_.push(m);
+        if (sleeping_.load()) {
+            std::lock_guard<std::mutex> lock(wake_mutex_); // Pairs with sleepUntilWork: no lost wakeups
+            wake_cv_.notify_one();
+        }
+        return confirmed;
+    }
+};
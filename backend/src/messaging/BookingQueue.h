@@ -0,0 +1,20 @@
+#pragma once
+#include <future>
+#include <string>
+
+// 📬 WHERE BOOKING EVENTS GO AFTER THE OUTBOX
+// The relay only needs "publish this, tell me when it's durable". Two transports:
+//   - AsyncPublisher: RabbitMQ with a confirm window (multi-box)
+//   - MmapLog: an embedded append-only log on local disk (single box, tests)
+// Pick one with TM_BOOKING_QUEUE=amqp|log (see messaging/QueueFactory.h).
+class BookingQueue {
+public:
+    virtual ~BookingQueue() = default;
+
+    // Never blocks; true once the event is durable (broker confirm / fsync), false if it never will be
+    virtual std::future<bool> publish(std::string body) = 0;
+    virtual const char* transport() const = 0;
+
+    // Events published but not consumed yet (for backpressure); -1 if the transport can't tell right now
+    virtual long long depth() { return -1; }
+};
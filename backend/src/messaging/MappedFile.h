@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 🗺️ A file mapped read-write and shared (other processes mapping it see the same bytes).
+// Created and zero-extended to `size` if shorter. flush() makes a byte range durable.
+class MappedFile {
+    char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+
+public:
+    MappedFile(const std::string& path, size_t size) : size_(size) {
+#ifdef _WIN32
+        // FILE_SHARE_DELETE so retention can remove a segment another process still has open
+        file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) throw std::runtime_error("open " + path + " failed");
+        // Mapping past EOF extends the file (zero-filled)
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr);
+        if (!mapping_) { CloseHandle(file_); throw std::runtime_error("map " + path + " failed"); }
+        data_ = (char*)MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (!data_) { CloseHandle(mapping_); CloseHandle(file_); throw std::runtime_error("view " + path + " failed"); }
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) throw std::runtime_error("open " + path + " failed");
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || ((size_t)st.st_size < size && ftruncate(fd_, (off_t)size) != 0)) {
+            ::close(fd_);
+            throw std::runtime_error("size " + path + " failed");
+        }
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) { ::close(fd_); throw std::runtime_error("map " + path + " failed"); }
+        data_ = (char*)p;
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+#else
+        munmap(data_, size_);
+        ::close(fd_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* data() { return data_; }
+    size_t size() const { return size_; }
+
+    // Durable once this returns (data pages, then file metadata)
+    void flush(size_t offset, size_t length) {
+        if (length == 0) return;
+#ifdef _WIN32
+        FlushViewOfFile(data_ + offset, length);
+        FlushFileBuffers(file_);
+#else
+        static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t start = offset / page * page; // msync wants a page-aligned address
+        msync(data_ + start, offset + length - start, MS_SYNC);
+#endif
+    }
+};
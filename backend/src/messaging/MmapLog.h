@@ -0,0 +1,429 @@
+#pragma once
+#include "BookingQueue.h"
+#include "MappedFile.h"
+#include "../metrics/Metrics.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <thread>
+#include <vector>
+
+// 🪵 EMBEDDED APPEND-ONLY LOG (local booking queue, no broker)
+// A directory of fixed-size, memory-mapped segment files plus a small "head" file:
+//
+//   head                       : u64 durable_offset (what readers may consume)
+//   00000000000000000000.seg   : records [0, SEGMENT)
+//   00000000000000000001.seg   : records [SEGMENT, 2*SEGMENT)   ...
+//   <consumer>.offset          : u64 next offset that consumer will read
+//
+//   Record: u32 length | u32 crc32(payload) | payload    (length 0xFFFFFFFF = rest of segment unused)
+//
+// Offsets are global byte positions, so offset / SEGMENT names the file.
+// Appends are memcpy into the mapping under one mutex. A flusher thread batches the fsync
+// (msync / FlushViewOfFile) every FSYNC_INTERVAL, then advances durable_offset and completes
+// the futures of everything it covered: publish() == true means the record is on disk, the same
+// promise a broker confirm makes. Readers (this process or another, e.g. booking_consumer)
+// never look past durable_offset.
+//
+// Recovery: on open the writer re-scans forward from durable_offset and keeps every record
+// whose CRC checks out, so a crash between the data fsync and the head update loses nothing.
+// Retention: a segment is deleted once every consumer has committed past it and it is older
+// than RETENTION. With no consumers registered nothing is ever deleted.
+namespace LogFormat {
+    constexpr uint32_t ROLL = 0xFFFFFFFF;
+    constexpr size_t RECORD_HEADER = 8;
+    constexpr size_t HEAD_SIZE = 4096;
+
+    inline uint32_t crc32(const char* data, size_t n) {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < n; i++) c = table[(c ^ (unsigned char)data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    inline uint32_t getU32(const char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+    inline void putU32(char* p, uint32_t v) { std::memcpy(p, &v, 4); }
+
+    inline std::string segmentName(uint64_t index) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%020llu.seg", (unsigned long long)index);
+        return buf;
+    }
+
+    // Lock-free 64-bit atomics are address-free, so one placed in a shared mapping is
+    // coherent across processes too.
+    inline std::atomic<uint64_t>* atomicAt(MappedFile& file) {
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "need lock-free 64-bit atomics");
+        return reinterpret_cast<std::atomic<uint64_t>*>(file.data());
+    }
+
+    struct Options {
+        std::string name = "log"; // Metric prefix
+        std::filesystem::path dir;
+        size_t segment_bytes = 64u << 20;
+        std::chrono::microseconds fsync_interval{2000};
+        std::chrono::seconds retention{3600};
+
+        // TM_LOG_DIR, TM_LOG_SEGMENT_MB, TM_LOG_FSYNC_US, TM_LOG_RETENTION_S
+        static Options fromEnv() {
+            auto env = [](const char* name) { const char* v = std::getenv(name); return v ? std::atoll(v) : 0LL; };
+            Options o;
+            const char* dir = std::getenv("TM_LOG_DIR");
+            o.dir = dir ? std::filesystem::path(dir) : std::filesystem::temp_directory_path() / "tm_booking_log";
+            if (env("TM_LOG_SEGMENT_MB") > 0) o.segment_bytes = (size_t)env("TM_LOG_SEGMENT_MB") << 20;
+            if (env("TM_LOG_FSYNC_US") > 0) o.fsync_interval = std::chrono::microseconds(env("TM_LOG_FSYNC_US"));
+            if (env("TM_LOG_RETENTION_S") > 0) o.retention = std::chrono::seconds(env("TM_LOG_RETENTION_S"));
+            return o;
+        }
+    };
+
+    inline std::string headPath(const Options& o) {
+        std::filesystem::create_directories(o.dir);
+        return (o.dir / "head").string();
+    }
+
+    // Where a brand-new consumer starts: the oldest segment retention has kept
+    inline uint64_t firstOffset(const Options& o) {
+        std::error_code ec;
+        uint64_t first = std::numeric_limits<uint64_t>::max();
+        for (const auto& entry : std::filesystem::directory_iterator(o.dir, ec)) {
+            if (entry.path().extension() != ".seg") continue;
+            first = std::min<uint64_t>(first, std::strtoull(entry.path().stem().string().c_str(), nullptr, 10));
+        }
+        return first == std::numeric_limits<uint64_t>::max() ? 0 : first * o.segment_bytes;
+    }
+}
+
+class MmapLog : public BookingQueue {
+private:
+    struct Pending {
+        uint64_t end; // Durable once durable_offset reaches this
+        std::promise<bool> done;
+    };
+
+    LogFormat::Options opts_;
+    MappedFile head_;
+    std::atomic<uint64_t>* durable_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::shared_ptr<MappedFile> segment_;
+    uint64_t segment_index_ = 0;
+    uint64_t write_pos_ = 0; // Global offset of the next record
+    std::deque<Pending> pending_;
+    std::atomic<uint64_t> appended_bytes_{0};   // For depth(): average record size
+    std::atomic<uint64_t> appended_records_{0};
+
+    LatencyHistogram* fsync_us_ = Metrics::GetInstance()->histogram(opts_.name + ".fsync_us");
+    LatencyHistogram* fsync_batch_ = Metrics::GetInstance()->histogram(opts_.name + ".fsync_batch");
+    std::atomic<long long>* rolls_ = Metrics::GetInstance()->counter(opts_.name + ".segment_rolls");
+    std::atomic<long long>* deleted_ = Metrics::GetInstance()->counter(opts_.name + ".segments_deleted");
+
+    uint64_t segmentBase(uint64_t index) const { return index * opts_.segment_bytes; }
+
+    std::shared_ptr<MappedFile> openSegment(uint64_t index) {
+        return std::make_shared<MappedFile>((opts_.dir / LogFormat::segmentName(index)).string(), opts_.segment_bytes);
+    }
+
+    // Continue after the last durable record, plus any complete records written after it
+    void recover() {
+        uint64_t pos = durable_->load();
+        segment_index_ = pos / opts_.segment_bytes;
+        segment_ = openSegment(segment_index_);
+        while (true) {
+            size_t in_seg = (size_t)(pos - segmentBase(segment_index_));
+            if (opts_.segment_bytes - in_seg < LogFormat::RECORD_HEADER) break;
+            const char* p = segment_->data() + in_seg;
+            uint32_t len = LogFormat::getU32(p);
+            if (len == 0 || len == LogFormat::ROLL || in_seg + LogFormat::RECORD_HEADER + len > opts_.segment_bytes) break;
+            if (LogFormat::crc32(p + LogFormat::RECORD_HEADER, len) != LogFormat::getU32(p + 4)) break;
+            pos += LogFormat::RECORD_HEADER + len;
+        }
+        if (pos != durable_->load()) {
+            std::cout << "🪵 Log recovered " << (pos - durable_->load()) << " bytes past the durable offset" << std::endl;
+        }
+        write_pos_ = pos;
+        segment_->flush(0, (size_t)(pos - segmentBase(segment_index_)));
+        durable_->store(pos);
+        head_.flush(0, sizeof(uint64_t));
+    }
+
+    bool fits(size_t body_size) const { return body_size > 0 && LogFormat::RECORD_HEADER + body_size <= opts_.segment_bytes; }
+
+    // Under mutex_; the body must fit()
+    void appendLocked(std::string_view body) {
+        size_t need = LogFormat::RECORD_HEADER + body.size();
+        if (write_pos_ - segmentBase(segment_index_) + need > opts_.segment_bytes) roll();
+        bool was_clean = write_pos_ == durable_->load();
+        char* p = segment_->data() + (write_pos_ - segmentBase(segment_index_));
+        std::memcpy(p + LogFormat::RECORD_HEADER, body.data(), body.size());
+        LogFormat::putU32(p + 4, LogFormat::crc32(body.data(), body.size()));
+        LogFormat::putU32(p, (uint32_t)body.size()); // Length last: a torn record reads as "nothing here"
+        write_pos_ += need;
+        appended_bytes_.fetch_add(need, std::memory_order_relaxed);
+        appended_records_.fetch_add(1, std::memory_order_relaxed);
+        if (was_clean) cv_.notify_one(); // First unflushed byte: wake the flusher
+    }
+
+    // Under mutex_: seal the current segment (fully durable) and move to the next
+    void roll() {
+        size_t in_seg = (size_t)(write_pos_ - segmentBase(segment_index_));
+        if (opts_.segment_bytes - in_seg >= 4) LogFormat::putU32(segment_->data() + in_seg, LogFormat::ROLL);
+        segment_->flush(0, opts_.segment_bytes);
+        segment_index_++;
+        write_pos_ = segmentBase(segment_index_);
+        segment_ = openSegment(segment_index_);
+        publishDurable(write_pos_); // Everything in the sealed segment is on disk now
+        rolls_->fetch_add(1, std::memory_order_relaxed);
+        applyRetention();
+    }
+
+    // Under mutex_
+    void publishDurable(uint64_t offset) {
+        if (offset <= durable_->load()) return;
+        durable_->store(offset, std::memory_order_release);
+        head_.flush(0, sizeof(uint64_t));
+        size_t n = 0;
+        while (!pending_.empty() && pending_.front().end <= offset) {
+            pending_.front().done.set_value(true);
+            pending_.pop_front();
+            n++;
+        }
+        if (n) fsync_batch_->record(n);
+    }
+
+    // Slowest consumer's committed offset; nullopt before any consumer has registered
+    std::optional<uint64_t> minCommitted() const {
+        std::error_code ec;
+        std::optional<uint64_t> min_committed;
+        for (const auto& entry : std::filesystem::directory_iterator(opts_.dir, ec)) {
+            if (entry.path().extension() != ".offset") continue;
+            MappedFile offset(entry.path().string(), sizeof(uint64_t));
+            uint64_t committed = LogFormat::atomicAt(offset)->load();
+            if (!min_committed || committed < *min_committed) min_committed = committed;
+        }
+        return min_committed;
+    }
+
+    void applyRetention() {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        auto slowest = minCommitted();
+        if (!slowest) return;
+        uint64_t min_committed = *slowest;
+        auto cutoff = fs::file_time_type::clock::now() - opts_.retention;
+        for (const auto& entry : fs::directory_iterator(opts_.dir, ec)) {
+            if (entry.path().extension() != ".seg") continue;
+            uint64_t index = std::strtoull(entry.path().stem().string().c_str(), nullptr, 10);
+            if (index >= segment_index_ || segmentBase(index + 1) > min_committed) continue;
+            if (entry.last_write_time(ec) > cutoff) continue;
+            if (fs::remove(entry.path(), ec)) deleted_->fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void runFlusher() {
+        while (true) {
+            std::shared_ptr<MappedFile> segment;
+            uint64_t from, to, base;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return write_pos_ > durable_->load(); });
+                lock.unlock();
+                std::this_thread::sleep_for(opts_.fsync_interval); // Let the batch fill up
+                lock.lock();
+                segment = segment_;
+                base = segmentBase(segment_index_);
+                from = std::max(durable_->load(), base);
+                to = write_pos_;
+            }
+            // fsync outside the lock: appends carry on into the same mapping meanwhile
+            auto start = std::chrono::steady_clock::now();
+            segment->flush((size_t)(from - base), (size_t)(to - from));
+            fsync_us_->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (segment == segment_) publishDurable(to); // A roll in between already covered it
+        }
+    }
+
+public:
+    explicit MmapLog(LogFormat::Options opts = LogFormat::Options::fromEnv())
+        : opts_(std::move(opts)),
+          head_(LogFormat::headPath(opts_), LogFormat::HEAD_SIZE),
+          durable_(LogFormat::atomicAt(head_)) {
+        recover();
+        std::cout << "🪵 Log '" << opts_.name << "' at " << opts_.dir.string() << " (offset " << write_pos_ << ")" << std::endl;
+        std::thread([this] { runFlusher(); }).detach();
+    }
+    MmapLog(const MmapLog&) = delete;
+    MmapLog& operator=(const MmapLog&) = delete;
+
+    const char* transport() const override { return "log"; }
+
+    std::future<bool> publish(std::string body) override {
+        std::promise<bool> done;
+        std::future<bool> result = done.get_future();
+        if (!fits(body.size())) { done.set_value(false); return result; }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        appendLocked(body);
+        pending_.push_back({write_pos_, std::move(done)});
+        return result;
+    }
+
+    // Fire-and-forget publish: durable with the next fsync batch, nobody waits for it
+    // (see barrier()). false if the record can never fit.
+    bool append(std::string_view body) {
+        if (!fits(body.size())) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        appendLocked(body);
+        return true;
+    }
+
+    uint64_t durableOffset() const { return durable_->load(); }
+
+    // End of everything appended so far, and a future that completes once it is all durable
+    std::pair<uint64_t, std::future<bool>> barrier() {
+        std::promise<bool> done;
+        std::future<bool> result = done.get_future();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (durable_->load() >= write_pos_) {
+            done.set_value(true);
+        } else {
+            pending_.push_back({write_pos_, std::move(done)}); // The flusher is already due: there is unflushed data
+        }
+        return {write_pos_, std::move(result)};
+    }
+
+    // Records behind the slowest consumer. Offsets are bytes, so this is bytes / the average
+    // record size seen by this process (a BookingEvent-sized guess until the first publish).
+    long long depth() override {
+        auto slowest = minCommitted();
+        if (!slowest) return -1;
+        uint64_t durable = durable_->load();
+        if (*slowest >= durable) return 0;
+        uint64_t records = appended_records_.load(std::memory_order_relaxed);
+        uint64_t avg = records ? appended_bytes_.load(std::memory_order_relaxed) / records : LogFormat::RECORD_HEADER + 64;
+        return (long long)((durable - *slowest) / std::max<uint64_t>(avg, 1));
+    }
+};
+
+// 📖 Reads one consumer's position forward; works in the writer's process or any other
+class LogReader {
+public:
+    struct Record {
+        uint64_t next;    // Commit this to mark the record consumed
+        std::string body;
+    };
+
+private:
+    LogFormat::Options opts_;
+    MappedFile head_;
+    MappedFile offset_file_;
+    std::atomic<uint64_t>* durable_;
+    std::atomic<uint64_t>* committed_;
+    uint64_t pos_ = 0;
+    uint64_t segment_index_ = std::numeric_limits<uint64_t>::max();
+    std::shared_ptr<MappedFile> segment_;
+
+    // Reads the record at pos_ (below the durable offset) and moves past it. false when pos_ was
+    // at the end of its segment instead: pos_ then moves to the start of the next one.
+    bool step(std::string_view& body) {
+        uint64_t index = pos_ / opts_.segment_bytes;
+        if (index != segment_index_) {
+            segment_ = std::make_shared<MappedFile>((opts_.dir / LogFormat::segmentName(index)).string(), opts_.segment_bytes);
+            segment_index_ = index;
+        }
+        size_t in_seg = (size_t)(pos_ - index * opts_.segment_bytes);
+        uint32_t len = opts_.segment_bytes - in_seg < LogFormat::RECORD_HEADER ? LogFormat::ROLL
+                                                                               : LogFormat::getU32(segment_->data() + in_seg);
+        if (len == LogFormat::ROLL || len == 0) { // 0 never gets written: treat damage like the end of the segment
+            pos_ = (index + 1) * opts_.segment_bytes;
+            return false;
+        }
+        body = std::string_view(segment_->data() + in_seg + LogFormat::RECORD_HEADER, len);
+        pos_ += LogFormat::RECORD_HEADER + len;
+        return true;
+    }
+
+public:
+    LogReader(const std::string& consumer, LogFormat::Options opts = LogFormat::Options::fromEnv())
+        : opts_(std::move(opts)),
+          head_(LogFormat::headPath(opts_), LogFormat::HEAD_SIZE),
+          offset_file_((opts_.dir / (consumer + ".offset")).string(), sizeof(uint64_t)),
+          durable_(LogFormat::atomicAt(head_)),
+          committed_(LogFormat::atomicAt(offset_file_)) {
+        if (committed_->load() == 0) commit(LogFormat::firstOffset(opts_)); // New consumer: from the oldest kept data
+        pos_ = committed_->load();
+    }
+
+    // Up to `max` records after the last poll, waiting up to `wait` for the first one
+    std::vector<Record> poll(size_t max, std::chrono::milliseconds wait) {
+        std::vector<Record> out;
+        auto deadline = std::chrono::steady_clock::now() + wait;
+        while (out.size() < max) {
+            uint64_t durable = durable_->load(std::memory_order_acquire);
+            if (pos_ >= durable) {
+                if (!out.empty() || std::chrono::steady_clock::now() >= deadline) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Cross-process: nothing to block on
+                continue;
+            }
+            std::string_view body;
+            if (!step(body)) continue; // Crossed into the next segment
+            out.push_back({pos_, std::string(body)});
+        }
+        return out;
+    }
+
+    // Every durable record from the current position on, without copying: visit(body, next).
+    // For replays (e.g. SeatLedger recovery); returns how many records were visited.
+    template <class F>
+    size_t scan(F&& visit) {
+        size_t n = 0;
+        uint64_t durable = durable_->load(std::memory_order_acquire);
+        while (pos_ < durable) {
+            std::string_view body;
+            if (!step(body)) continue;
+            visit(body, pos_);
+            n++;
+        }
+        return n;
+    }
+
+    // Durably records progress (and lets retention drop what's behind it)
+    void commit(uint64_t next) {
+        committed_->store(next, std::memory_order_release);
+        offset_file_.flush(0, sizeof(uint64_t));
+    }
+
+    uint64_t committed() const { return committed_->load(); }
+
+    // After a failed batch: read it again from the last commit
+    void rewind() { pos_ = committed_->load(); }
+
+    // Reads from `offset` next (a record boundary, e.g. one saved in a snapshot)
+    void seek(uint64_t offset) { pos_ = offset; }
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include "AsyncPublisher.h"
+#include "BookingQueue.h"
+#include "MmapLog.h"
+#include <cstdlib>
+#include <string>
+
+// TM_BOOKING_QUEUE=log -> embedded log (TM_LOG_DIR), anything else -> RabbitMQ queue `queue`
+inline BookingQueue* openBookingQueue(const std::string& queue) {
+    const char* kind = std::getenv("TM_BOOKING_QUEUE");
+    if (kind && std::string(kind) == "log") return new MmapLog();
+    return new AsyncPublisher(queue);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include "../codec/JsonWriter.h"
+
+// 📊 LOCK-FREE LATENCY HISTOGRAM
+// Power-of-two buckets in microseconds: bucket i counts samples in [2^(i-1), 2^i).
+// record() is a couple of relaxed atomic adds, so it is safe on the request path.
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 32; // Up to ~35 minutes, more than enough
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+
+    static int bucketFor(uint64_t us) {
+        int b = 0;
+        while (us > 0 && b < BUCKETS - 1) { us >>= 1; b++; }
+        return b;
+    }
+
+public:
+    void record(uint64_t us) {
+        buckets_[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t prev = max_us_.load(std::memory_order_relaxed);
+        while (us > prev && !max_us_.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    // Upper bound (in us) of the bucket holding the q-th quantile
+    uint64_t percentile(double q) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+        uint64_t target = (uint64_t)(q * total);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen > target) return i == 0 ? 0 : (1ULL << i);
+        }
+        return max_us_.load(std::memory_order_relaxed);
+    }
+
+    void writeJson(JsonWriter& w) const {
+        uint64_t total = count();
+        w.beginObject()
+         .field("count", total)
+         .field("avg_us", total ? (double)sum_us_.load(std::memory_order_relaxed) / total : 0.0)
+         .field("p50_us", percentile(0.50))
+         .field("p99_us", percentile(0.99))
+         .field("max_us", max_us_.load(std::memory_order_relaxed))
+         .key("buckets").beginArray();
+        for (int i = 0; i < BUCKETS; i++) {
+            uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+            if (n == 0) continue;
+            w.beginObject().field("le_us", i == 0 ? 0 : (1ULL << i)).field("count", n).endObject();
+        }
+        w.endArray().endObject();
+    }
+};
+
+// 🧮 NAMED METRICS REGISTRY
+// Lookups take a mutex, so hot paths should look a metric up once and keep the pointer.
+// Entries are never removed, which keeps those pointers valid for the process lifetime.
+class Metrics {
+private:
+    static Metrics* instance;
+    static std::mutex instance_mutex_;
+
+    std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;
+    std::map<std::string, std::unique_ptr<std::atomic<long long>>> counters_;
+
+    Metrics() {}
+
+public:
+    static Metrics* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new Metrics();
+        return instance;
+    }
+
+    LatencyHistogram* histogram(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = histograms_[name];
+        if (!slot) slot = std::make_unique<LatencyHistogram>();
+        return slot.get();
+    }
+
+    std::atomic<long long>* counter(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = counters_[name];
+        if (!slot) slot = std::make_unique<std::atomic<long long>>(0);
+        return slot.get();
+    }
+
+    std::string toJson() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string& buf = JsonWriter::threadBuffer();
+        JsonWriter w(buf);
+        w.beginObject().key("counters").beginObject();
+        for (auto& [name, c] : counters_) w.field(name, c->load(std::memory_order_relaxed));
+        w.endObject().key("histograms").beginObject();
+        for (auto& [name, h] : histograms_) { w.key(name); h->writeJson(w); }
+        w.endObject().endObject();
+        return buf;
+    }
+};
+
+Metrics* Metrics::instance = nullptr;
+std::mutex Metrics::instance_mutex_;
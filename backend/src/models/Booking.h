@@ -1,7 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <crow/json.h>
+#include "../codec/JsonWriter.h"
 
 struct Booking {
     int id;
@@ -12,14 +12,14 @@ struct Booking {
     std::string booking_time;
     
     // Helper to send to frontend
-    crow::json::wvalue toJson() const {
-        crow::json::wvalue json;
-        json["id"] = id;
-        json["user_id"] = user_id;
-        json["show_id"] = show_id;
-        json["status"] = status;
-        json["amount"] = total_amount;
-        json["time"] = booking_time;
-        return json;
+    void writeJson(JsonWriter& w) const {
+        w.beginObject()
+         .field("id", id)
+         .field("user_id", user_id)
+         .field("show_id", show_id)
+         .field("status", status)
+         .field("amount", total_amount)
+         .field("time", booking_time)
+         .endObject();
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "../codec/JsonWriter.h"
+
+struct Show {
+    int id;
+    std::string movie_name;
+    std::string start_time;
+    double price;
+
+    // Helper to send to frontend
+    void writeJson(JsonWriter& w) const {
+        w.beginObject()
+         .field("id", id)
+         .field("movie", movie_name)
+         .field("time", start_time)
+         .field("price", price)
+         .endObject();
+    }
+
+    static void writeJsonArray(JsonWriter& w, const std::vector<Show>& shows) {
+        w.beginArray();
+        for (const auto& s : shows) s.writeJson(w);
+        w.endArray();
+    }
+
+    // JSON array for a whole listing (only rendered at the HTTP edge)
+    static std::string toJsonArray(const std::vector<Show>& shows) {
+        std::string& buf = JsonWriter::threadBuffer();
+        JsonWriter w(buf);
+        writeJsonArray(w, shows);
+        return buf;
+    }
+};
@@ -0,0 +1,188 @@
+#pragma once
+#include "../db.h"
+#include "../messaging/BookingQueue.h"
+#include "../metrics/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// 🚦 BOOKING BACKPRESSURE
+// /api/pay answers PROCESSING as soon as the outbox has the event; booking_consumer commits
+// it later. If the consumer falls behind, that "later" grows without bound and seat holds
+// (SEAT_HOLD_TTL_S) lapse before the booking lands, so someone else can grab the seat.
+//
+// Every SAMPLE_EVERY the server estimates the end-to-end lag:
+//   outbox age  : how long the oldest unrelayed row has waited (shared table, every server agrees)
+//   queue lag   : broker/log depth divided by the consumer's observed drain rate; if it
+//                 isn't draining at all, how long it has been stuck
+// and picks a level:
+//   EXTEND_HOLDS : paid seats' holds are stretched to cover the lag (holdTtl)
+//   SHED         : new payments get 503 + Retry-After until the backlog drains
+// Thresholds: TM_LAG_EXTEND_MS, TM_LAG_SHED_MS, TM_QUEUE_EXTEND_DEPTH, TM_QUEUE_SHED_DEPTH.
+class BookingBackpressure {
+public:
+    enum class Level { NORMAL = 0, EXTEND_HOLDS = 1, SHED = 2 };
+
+    static constexpr std::chrono::seconds SAMPLE_EVERY{1};
+    static constexpr int MAX_HOLD_TTL_S = 900;
+    static constexpr int MAX_RETRY_AFTER_S = 30;
+
+    struct Thresholds {
+        long long extend_lag_ms = 30000;  // A quarter of the default hold
+        long long shed_lag_ms = 90000;
+        long long extend_depth = 5000;
+        long long shed_depth = 50000;
+
+        static Thresholds fromEnv() {
+            auto env = [](const char* name, long long fallback) {
+                const char* v = std::getenv(name);
+                return v && std::atoll(v) > 0 ? std::atoll(v) : fallback;
+            };
+            Thresholds t;
+            t.extend_lag_ms = env("TM_LAG_EXTEND_MS", t.extend_lag_ms);
+            t.shed_lag_ms = env("TM_LAG_SHED_MS", t.shed_lag_ms);
+            t.extend_depth = env("TM_QUEUE_EXTEND_DEPTH", t.extend_depth);
+            t.shed_depth = env("TM_QUEUE_SHED_DEPTH", t.shed_depth);
+            return t;
+        }
+    };
+
+private:
+    static BookingBackpressure* instance;
+    static std::mutex instance_mutex_;
+
+    Thresholds limits_ = Thresholds::fromEnv();
+    std::atomic<long long> lag_ms_{0};
+    std::atomic<int> level_{(int)Level::NORMAL};
+    std::atomic<bool> running_{false};
+
+    // Sampler-thread state
+    long long last_depth_ = -1;
+    long long last_relayed_ = 0;
+    double drain_per_s_ = 0; // Smoothed consumer throughput
+    std::chrono::steady_clock::time_point last_sample_ = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point last_progress_ = last_sample_;
+
+    std::atomic<long long>* relayed_ = Metrics::GetInstance()->counter("outbox.relayed");
+    // Gauges (latest sample) kept as counters, like everything else in /api/metrics
+    std::atomic<long long>* lag_gauge_ = Metrics::GetInstance()->counter("backpressure.lag_ms");
+    std::atomic<long long>* depth_gauge_ = Metrics::GetInstance()->counter("backpressure.queue_depth");
+    std::atomic<long long>* outbox_rows_gauge_ = Metrics::GetInstance()->counter("backpressure.outbox_rows");
+    std::atomic<long long>* outbox_age_gauge_ = Metrics::GetInstance()->counter("backpressure.outbox_age_ms");
+    std::atomic<long long>* level_gauge_ = Metrics::GetInstance()->counter("backpressure.level");
+    std::atomic<long long>* shed_ = Metrics::GetInstance()->counter("backpressure.shed");
+    std::atomic<long long>* extended_ = Metrics::GetInstance()->counter("backpressure.holds_extended");
+
+    BookingBackpressure() {}
+
+    // How long a message now at the back of the queue will wait for the consumer
+    long long queueLagMs(long long depth, std::chrono::steady_clock::time_point now) {
+        long long elapsed_ms = std::max<long long>(1, std::chrono::duration_cast<std::chrono::milliseconds>(now - last_sample_).count());
+        long long relayed = relayed_->load(std::memory_order_relaxed);
+        long long lag = 0;
+        if (depth <= 0) {
+            last_progress_ = now;
+        } else {
+            if (last_depth_ >= 0) {
+                long long consumed = last_depth_ + (relayed - last_relayed_) - depth; // In minus what's still there
+                if (consumed > 0) {
+                    double rate = consumed * 1000.0 / elapsed_ms;
+                    drain_per_s_ = drain_per_s_ > 0 ? 0.7 * drain_per_s_ + 0.3 * rate : rate;
+                    last_progress_ = now;
+                }
+            }
+            long long stalled_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_progress_).count();
+            lag = drain_per_s_ > 0 ? std::max((long long)(depth * 1000 / drain_per_s_), stalled_ms) : stalled_ms;
+        }
+        last_depth_ = depth;
+        last_relayed_ = relayed;
+        last_sample_ = now;
+        return lag;
+    }
+
+    void sample(BookingQueue* queue) {
+        long long outbox_rows, outbox_age_ms;
+        {
+            DBConnection conn(PoolType::MASTER);
+            pqxx::work txn(*conn);
+            pqxx::result res = txn.exec_prepared(Statements::OUTBOX_LAG);
+            outbox_rows = res[0][0].as<long long>();
+            outbox_age_ms = res[0][1].as<long long>();
+        }
+        long long depth = queue ? queue->depth() : -1;
+        long long lag = outbox_age_ms + queueLagMs(depth, std::chrono::steady_clock::now());
+
+        Level level = Level::NORMAL;
+        if (lag >= limits_.shed_lag_ms || depth >= limits_.shed_depth) level = Level::SHED;
+        else if (lag >= limits_.extend_lag_ms || depth >= limits_.extend_depth) level = Level::EXTEND_HOLDS;
+        if ((int)level != level_.load()) {
+            std::cout << "🚦 Booking backpressure: level " << (int)level << " (lag " << lag << "ms, depth " << depth
+                      << ", outbox " << outbox_rows << ")" << std::endl;
+        }
+
+        lag_ms_ = lag;
+        level_ = (int)level;
+        lag_gauge_->store(lag, std::memory_order_relaxed);
+        depth_gauge_->store(depth, std::memory_order_relaxed);
+        outbox_rows_gauge_->store(outbox_rows, std::memory_order_relaxed);
+        outbox_age_gauge_->store(outbox_age_ms, std::memory_order_relaxed);
+        level_gauge_->store((long long)level, std::memory_order_relaxed);
+    }
+
+    void run(BookingQueue* queue) {
+        while (true) {
+            try {
+                sample(queue);
+            } catch (const std::exception& e) {
+                // Keep the last reading: a DB blip shouldn't flip shedding on or off
+                std::cerr << "⚠️ Backpressure sample failed: " << e.what() << std::endl;
+            }
+            std::this_thread::sleep_for(SAMPLE_EVERY);
+        }
+    }
+
+public:
+    static BookingBackpressure* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new BookingBackpressure();
+        return instance;
+    }
+
+    // Starts sampling the outbox and `queue` (the relay's transport; may be nullptr)
+    void start(BookingQueue* queue) {
+        if (running_.exchange(true)) return;
+        std::thread([this, queue] { run(queue); }).detach();
+    }
+
+    Level level() const { return (Level)level_.load(std::memory_order_relaxed); }
+    long long lagMs() const { return lag_ms_.load(std::memory_order_relaxed); }
+
+    // false = shed this payment (counted)
+    bool admit() {
+        if (level() != Level::SHED) return true;
+        shed_->fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Retry-After for a shed payment: a tenth of the lag, 1..MAX_RETRY_AFTER_S seconds
+    int retryAfterSeconds() const {
+        long long s = (lagMs() + 9999) / 10000;
+        return (int)std::clamp<long long>(s, 1, MAX_RETRY_AFTER_S);
+    }
+
+    // Hold TTL for a seat whose booking is in flight: base, or long enough to outlast twice the lag
+    int holdTtl(int base_ttl_s) const {
+        if (level() == Level::NORMAL) return base_ttl_s;
+        long long needed = base_ttl_s + 2 * ((lagMs() + 999) / 1000);
+        return (int)std::min<long long>(needed, MAX_HOLD_TTL_S);
+    }
+
+    void recordExtended(size_t seats) { extended_->fetch_add((long long)seats, std::memory_order_relaxed); }
+};
+
+BookingBackpressure* BookingBackpressure::instance = nullptr;
+std::mutex BookingBackpressure::instance_mutex_;
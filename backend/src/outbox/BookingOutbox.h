@@ -0,0 +1,204 @@
+#pragma once
+#include "../db.h"
+#include "../codec/Wire.h"
+#include "../dao/WriteCombiner.h"
+#include "../messaging/QueueFactory.h"
+#include "../metrics/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 📤 TRANSACTIONAL OUTBOX FOR BOOKING INTENTS
+// /api/pay used to publish to RabbitMQ and, if the broker was down, book synchronously
+// instead: two very different latency profiles depending on broker health. Now it always
+// does the same thing: append the encoded BookingEvent to the booking_outbox table.
+//
+// Writer: concurrent intents are group-committed through a WriteCombiner (up to MAX_BATCH per
+// INSERT ... unnest, lingering at most MAX_WAIT_US), so the per-payment cost is a share of one commit.
+//
+// Relay: leases up to RELAY_BATCH rows for RELAY_LEASE (SKIP LOCKED, so every server can run
+// one) and commits right away, so no connection or row lock is held while publishing to the
+// BookingQueue (RabbitMQ or the embedded log). It waits at most CONFIRM_WAIT for the confirms,
+// then a second short transaction deletes the confirmed rows and releases the rest for the
+// next round. A relay that dies mid-round just lets its lease lapse. A down broker makes the
+// relay back off (RELAY_BACKOFF_MIN doubling up to RELAY_BACKOFF_MAX); the outbox just
+// grows until it comes back. Delivery is at-least-once, like the queue itself (the consumer
+// dedupes on the idempotency key).
+class BookingOutbox {
+public:
+    static constexpr size_t MAX_BATCH = 128;
+    static constexpr long long MAX_WAIT_US = 500;
+    static constexpr int FLUSHERS = 2;
+    static constexpr int RELAY_BATCH = 500;
+    static constexpr std::chrono::seconds RELAY_LEASE{60};           // Outlives CONFIRM_WAIT by a wide margin
+    static constexpr std::chrono::seconds CONFIRM_WAIT{20};
+    static constexpr std::chrono::milliseconds RELAY_IDLE{200};      // Poll interval when the outbox is empty
+    static constexpr std::chrono::milliseconds RELAY_BACKOFF_MIN{100};
+    static constexpr std::chrono::milliseconds RELAY_BACKOFF_MAX{5000};
+
+private:
+    static BookingOutbox* instance;
+    static std::mutex instance_mutex_;
+
+    // Lets a commit wake the relay instead of it waiting out RELAY_IDLE
+    std::mutex relay_mutex_;
+    std::condition_variable relay_cv_;
+    bool relay_kick_ = false;
+    std::atomic<bool> relay_running_{false};
+    std::atomic<BookingQueue*> relay_queue_{nullptr};
+
+    std::atomic<long long>* write_failed_ = Metrics::GetInstance()->counter("outbox.write_failed");
+    std::atomic<long long>* relayed_ = Metrics::GetInstance()->counter("outbox.relayed");
+    std::atomic<long long>* relay_failed_ = Metrics::GetInstance()->counter("outbox.relay_failed");
+    LatencyHistogram* relay_lag_ms_ = Metrics::GetInstance()->histogram("outbox.relay_lag_ms");
+
+    // Declared last: its flushers may call flush() as soon as it exists
+    WriteCombiner<std::string, bool> writer_{"outbox.write", MAX_BATCH, MAX_WAIT_US, FLUSHERS,
+                                             [this](std::vector<std::string>& batch) { return flush(batch); }};
+
+    BookingOutbox() {}
+
+    // =========================================================
+    // WRITER (one multi-row INSERT per combined batch)
+    // =========================================================
+    std::vector<bool> flush(std::vector<std::string>& batch) {
+        std::vector<std::string> payloads;
+        payloads.reserve(batch.size());
+        for (const auto& p : batch) payloads.push_back(Wire::toHex(p));
+
+        bool ok = true;
+        try {
+            DBConnection conn(PoolType::MASTER);
+            pqxx::work txn(*conn);
+            txn.exec_prepared(Statements::OUTBOX_INSERT, Statements::textArray(payloads));
+            txn.commit();
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Outbox batch of " << batch.size() << " failed: " << e.what() << std::endl;
+            write_failed_->fetch_add((long long)batch.size(), std::memory_order_relaxed);
+            ok = false;
+        }
+        if (ok) kickRelay();
+        return std::vector<bool>(batch.size(), ok);
+    }
+
+    // =========================================================
+    // RELAY (outbox -> BookingQueue)
+    // =========================================================
+    void kickRelay() {
+        {
+            std::lock_guard<std::mutex> lock(relay_mutex_);
+            relay_kick_ = true;
+        }
+        relay_cv_.notify_one();
+    }
+
+    void waitForWork(std::chrono::milliseconds max_wait) {
+        std::unique_lock<std::mutex> lock(relay_mutex_);
+        relay_cv_.wait_for(lock, max_wait, [this] { return relay_kick_; });
+        relay_kick_ = false;
+    }
+
+    // One round: returns how many rows were claimed, throws if the broker confirmed none of them
+    size_t relayOnce(BookingQueue& queue) {
+        std::vector<long long> ids;
+        std::vector<long long> ages_ms;
+        std::vector<std::string> payloads;
+        {
+            DBConnection conn(PoolType::MASTER);
+            pqxx::work txn(*conn);
+            pqxx::result rows = txn.exec_prepared(Statements::OUTBOX_CLAIM, RELAY_BATCH, (int)RELAY_LEASE.count());
+            txn.commit();
+            for (auto row : rows) {
+                ids.push_back(row[0].as<long long>());
+                payloads.push_back(row[1].as<std::string>());
+                ages_ms.push_back(row[2].as<long long>());
+            }
+        }
+        if (ids.empty()) return 0;
+
+        // Publish the whole batch at once; the confirm window settles them together
+        std::vector<std::future<bool>> confirms(ids.size());
+        std::vector<long long> done, retry;
+        std::string payload;
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (!Wire::fromHex(payloads[i], payload)) {
+                // Can't happen short of manual edits; don't let one bad row block the outbox
+                std::cerr << "❌ Dropping corrupt outbox row " << ids[i] << std::endl;
+                done.push_back(ids[i]);
+                continue;
+            }
+            confirms[i] = queue.publish(payload);
+        }
+
+        size_t dropped = done.size();
+        auto deadline = std::chrono::steady_clock::now() + CONFIRM_WAIT;
+        for (size_t i = 0; i < confirms.size(); i++) {
+            if (!confirms[i].valid()) continue;
+            bool ok = confirms[i].wait_until(deadline) == std::future_status::ready && confirms[i].get();
+            if (!ok) { retry.push_back(ids[i]); continue; }
+            done.push_back(ids[i]);
+            relay_lag_ms_->record(ages_ms[i]);
+        }
+        {
+            DBConnection conn(PoolType::MASTER);
+            pqxx::work txn(*conn);
+            if (!done.empty()) txn.exec_prepared(Statements::OUTBOX_DELETE, Statements::intArray(done));
+            if (!retry.empty()) txn.exec_prepared(Statements::OUTBOX_RELEASE, Statements::intArray(retry));
+            txn.commit();
+        }
+
+        relayed_->fetch_add((long long)(done.size() - dropped), std::memory_order_relaxed);
+        relay_failed_->fetch_add((long long)retry.size(), std::memory_order_relaxed);
+        if (done.size() == dropped && !retry.empty()) throw std::runtime_error("broker confirmed none of " + std::to_string(ids.size()) + " messages");
+        return ids.size();
+    }
+
+    void runRelay(BookingQueue* queue) {
+        auto backoff = RELAY_BACKOFF_MIN;
+        while (true) {
+            try {
+                size_t claimed = relayOnce(*queue);
+                backoff = RELAY_BACKOFF_MIN;
+                if (claimed < (size_t)RELAY_BATCH) waitForWork(RELAY_IDLE); // Drained: wait for the next commit
+            } catch (const std::exception& e) {
+                std::cerr << "⚠️ Outbox relay: " << e.what() << " (retrying in " << backoff.count() << "ms)" << std::endl;
+                std::this_thread::sleep_for(backoff);
+                backoff = std::min(backoff * 2, RELAY_BACKOFF_MAX);
+            }
+        }
+    }
+
+public:
+    static BookingOutbox* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new BookingOutbox();
+        return instance;
+    }
+
+    // Starts this process's relay into `queue` (call once at startup)
+    void startRelay(const std::string& queue) {
+        if (relay_running_.exchange(true)) return;
+        BookingQueue* target = openBookingQueue(queue);
+        relay_queue_ = target;
+        std::cout << "📤 Outbox relay -> " << target->transport() << std::endl;
+        std::thread([this, target] { runRelay(target); }).detach();
+    }
+
+    // The relay's transport (nullptr before startRelay)
+    BookingQueue* queue() const { return relay_queue_.load(); }
+
+    // Durably records an encoded BookingEvent; false if the outbox write failed
+    bool append(std::string payload) {
+        return writer_.submit(std::move(payload)).get();
+    }
+};
+
+BookingOutbox* BookingOutbox::instance = nullptr;
+std::mutex BookingOutbox::instance_mutex_;
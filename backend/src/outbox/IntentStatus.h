@@ -0,0 +1,167 @@
+#pragma once
+#include "crow.h"
+#include "../redis_manager.h"
+#include "../metrics/Metrics.h"
+#include "../codec/JsonWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// 🧾 BOOKING INTENT STATUS
+// /api/pay answers with an intent id (the event's idempotency key) instead of a bare PROCESSING.
+// Its status is one Redis key, intent:<id>, kept INTENT_TTL_S:
+//   {"status":"PROCESSING","intent_id":...}                 written by /api/pay
+//   {"status":"CONFIRMED","intent_id":...,"booking_id":42}  written by booking_consumer after commit
+//   {"status":"FAILED","intent_id":...}                     the DB refused it (e.g. seat already sold)
+// The consumer also publishes the final status on the "intents" channel ("<id>\n<json>"; ids come
+// from a header, so they can't hold a newline). Every server listens and wakes the long-polls
+// parked on that id, so a client hears about its booking without polling its whole history.
+//
+// A parked long-poll holds a Crow worker thread: at most MAX_WAITERS park at once (the server
+// runs that many extra workers), past that the current status is returned right away.
+class IntentStatus {
+public:
+    static constexpr const char* CHANNEL = "intents";
+    static constexpr const char* KEY_PREFIX = "intent:";
+    static constexpr int INTENT_TTL_S = 86400;   // Same as the idempotency record
+    static constexpr int MAX_WAIT_S = 25;        // Under common proxy idle timeouts
+
+private:
+    struct Slot {
+        std::condition_variable cv;
+        std::optional<std::string> final_status;
+        int waiters = 0;
+    };
+
+    static IntentStatus* instance;
+    static std::mutex instance_mutex_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Slot>> slots_; // Only ids someone is waiting on
+    std::atomic<int> parked_{0};
+    std::atomic<bool> running_{false};
+
+    std::atomic<long long>* notified_ = Metrics::GetInstance()->counter("intents.notified");
+    std::atomic<long long>* wait_full_ = Metrics::GetInstance()->counter("intents.wait_rejected");
+    LatencyHistogram* wait_ms_ = Metrics::GetInstance()->histogram("intents.wait_ms");
+
+    IntentStatus() {}
+
+    // "status" must stay the first key: isFinal() looks at the prefix
+    static std::string toJson(const std::string& id, const char* status, int booking_id = -1) {
+        std::string& buf = JsonWriter::threadBuffer();
+        JsonWriter w(buf);
+        w.beginObject().field("status", status).field("intent_id", id);
+        if (booking_id >= 0) w.field("booking_id", booking_id);
+        w.endObject();
+        return buf;
+    }
+
+    void onMessage(const std::string& message) {
+        size_t split = message.find('\n');
+        if (split == std::string::npos) return;
+        std::string id = message.substr(0, split);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = slots_.find(id);
+        if (it == slots_.end()) return; // Nobody here is waiting on it
+        it->second->final_status = message.substr(split + 1);
+        it->second->cv.notify_all();
+        notified_->fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    static IntentStatus* GetInstance() {
+        std::lock_guard<std::mutex> lock(instance_mutex_);
+        if (instance == nullptr) instance = new IntentStatus();
+        return instance;
+    }
+
+    // TM_STATUS_WAITERS, default 64
+    static int maxWaiters() {
+        static const int n = [] {
+            const char* v = std::getenv("TM_STATUS_WAITERS");
+            return v ? std::max(0, std::atoi(v)) : 64;
+        }();
+        return n;
+    }
+
+    static bool isFinal(const std::string& status_json) {
+        return status_json.rfind("{\"status\":\"PROCESSING\"", 0) != 0;
+    }
+
+    // =========================================================
+    // WRITERS (/api/pay, booking_consumer)
+    // =========================================================
+    static void markProcessing(const std::string& id) {
+        RedisManager::GetInstance()->setSession(KEY_PREFIX + id, toJson(id, "PROCESSING"), INTENT_TTL_S);
+    }
+
+    // booking_id < 0: the consumer couldn't book it
+    static void markDone(const std::string& id, int booking_id) {
+        std::string status = toJson(id, booking_id >= 0 ? "CONFIRMED" : "FAILED", booking_id);
+        auto* redis = RedisManager::GetInstance();
+        redis->setSession(KEY_PREFIX + id, status, INTENT_TTL_S);
+        redis->publish(CHANNEL, id + "\n" + status);
+    }
+
+    // =========================================================
+    // READERS (/api/bookings/status)
+    // =========================================================
+    void start() {
+        if (running_.exchange(true)) return;
+        RedisManager::GetInstance()->subscribe(CHANNEL, [this](const std::string& message) { onMessage(message); });
+    }
+
+    // Current status; nullopt if the id is unknown (never issued, or expired)
+    std::optional<std::string> get(const std::string& id) {
+        return RedisManager::GetInstance()->getSession(KEY_PREFIX + id);
+    }
+
+    // Like get(), but while it is PROCESSING waits up to `wait` for the consumer's notification
+    std::optional<std::string> await(const std::string& id, std::chrono::seconds wait) {
+        wait = std::min(wait, std::chrono::seconds(MAX_WAIT_S));
+        if (wait.count() <= 0) return get(id);
+        if (parked_.fetch_add(1) >= maxWaiters()) {
+            parked_.fetch_sub(1);
+            wait_full_->fetch_add(1, std::memory_order_relaxed);
+            return get(id);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<Slot> slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& entry = slots_[id];
+            if (!entry) entry = std::make_shared<Slot>();
+            slot = entry;
+            slot->waiters++;
+        }
+        // Read after registering: a commit that lands in between still wakes us (or is seen here)
+        std::optional<std::string> status = get(id);
+        if (status && !isFinal(*status)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            slot->cv.wait_for(lock, wait, [&] { return slot->final_status.has_value(); });
+            if (slot->final_status) status = slot->final_status;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--slot->waiters == 0) slots_.erase(id);
+        }
+        parked_.fetch_sub(1);
+        wait_ms_->record(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+        // Pub/sub is fire-and-forget: if the wait timed out, Redis still has the latest word
+        if (status && !isFinal(*status)) status = get(id);
+        return status;
+    }
+};
+
+IntentStatus* IntentStatus::instance = nullptr;
+std::mutex IntentStatus::instance_mutex_;
@@ -4,6 +4,10 @@
 #include <mutex>
 #include <vector>
 #include <optional>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <thread>
 
 using namespace sw::redis;
 
@@ -50,6 +54,22 @@ public:
         } catch (...) { return false; }
     }
 
+    // ⏳ Push held keys out to ttl_seconds (never shortens a hold; keys that already lapsed stay gone)
+    bool extendLocks(const std::vector<std::string>& keys, int ttl_seconds) {
+        std::string script = R"(
+            for i, key in ipairs(KEYS) do
+                local ttl = redis.call("TTL", key)
+                if ttl >= 0 and ttl < tonumber(ARGV[1]) then redis.call("EXPIRE", key, ARGV[1]) end
+            end
+            return 1
+        )";
+        try {
+            std::vector<std::string> args = {std::to_string(ttl_seconds)};
+            redis->eval<long long>(script, keys.begin(), keys.end(), args.begin(), args.end());
+            return true;
+        } catch (...) { return false; }
+    }
+
     // 🛡️ RATE LIMITER (Fixed Lua Syntax)
     bool checkRateLimit(const std::string& ip_address, int limit, int window_seconds) {
         std::string key = "ratelimit:" + ip_address;
@@ -91,6 +111,85 @@ public:
         } catch (...) {}
         return std::nullopt;
     }
+
+    // 📣 PUB/SUB (fire-and-forget: listeners must tolerate missed messages)
+    void publish(const std::string& channel, const std::string& message) {
+        try { redis->publish(channel, message); } catch (...) {}
+    }
+
+    // Calls `handler` for every message on `channel`, from a background thread. Resubscribes after errors.
+    void subscribe(const std::string& channel, std::function<void(const std::string&)> handler) {
+        if (!redis) return;
+        std::thread([this, channel, handler] {
+            while (true) {
+                try {
+                    auto sub = redis->subscriber();
+                    sub.on_message([&handler](std::string, std::string message) { handler(message); });
+                    sub.subscribe(channel);
+                    while (true) {
+                        try { sub.consume(); }
+                        catch (const TimeoutError&) {} // Quiet channel, socket_timeout elapsed
+                    }
+                } catch (const Error& e) {
+                    std::cerr << "⚠️ Redis subscription '" << channel << "' lost: " << e.what() << std::endl;
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                }
+            }
+        }).detach();
+    }
+
+    // ⏩ CACHE ENTRY + REFRESH-AHEAD METADATA
+    // The recompute cost lives in a sibling "<key>:delta" key with the same TTL,
+    // so every node sees the same cost without changing the cached value format.
+    struct CacheEntry {
+        std::string value;
+        long long ttl_ms;  // Remaining TTL (PTTL)
+        double delta_ms;   // Last recompute cost, 0 if unknown
+    };
+
+    std::optional<CacheEntry> getWithMeta(const std::string& key) {
+        try {
+            // One round trip: GET + PTTL + GET delta
+            auto replies = redis->pipeline(false).get(key).pttl(key).get(key + ":delta").exec();
+            auto val = replies.get<OptionalString>(0);
+            if (!val) return std::nullopt;
+            auto delta = replies.get<OptionalString>(2);
+            return CacheEntry{*val, replies.get<long long>(1), delta ? std::atof(delta->c_str()) : 0.0};
+        } catch (...) {}
+        return std::nullopt;
+    }
+
+    void setWithMeta(const std::string& key, const std::string& val, int ttl, double delta_ms) {
+        try {
+            redis->pipeline(false)
+                .set(key, val, std::chrono::seconds(ttl))
+                .set(key + ":delta", std::to_string(delta_ms), std::chrono::seconds(ttl))
+                .exec();
+        } catch (...) {}
+    }
+
+    // 📚 BATCH READ: one MGET for many keys, result[i] matches keys[i]
+    std::vector<std::optional<std::string>> getMany(const std::vector<std::string>& keys) {
+        std::vector<OptionalString> vals;
+        vals.reserve(keys.size());
+        try {
+            redis->mget(keys.begin(), keys.end(), std::back_inserter(vals));
+        } catch (...) { vals.assign(keys.size(), std::nullopt); }
+        return vals;
+    }
+
+    // 📚 BATCH WRITE: every (key, value) plus its refresh-ahead delta in one pipelined round trip
+    void setManyWithMeta(const std::vector<std::pair<std::string, std::string>>& entries, int ttl, double delta_ms) {
+        if (entries.empty()) return;
+        try {
+            auto pipe = redis->pipeline(false);
+            for (const auto& [key, val] : entries) {
+                pipe.set(key, val, std::chrono::seconds(ttl))
+                    .set(key + ":delta", std::to_string(delta_ms), std::chrono::seconds(ttl));
+            }
+            pipe.exec();
+        } catch (...) {}
+    }
 };
 
 RedisManager* RedisManager::instance = nullptr;
@@ -4,6 +4,34 @@ import axios from 'axios';
 // ✅ POINTING TO SAFE PORT 8090
 const API_URL = "http://localhost:8090/api";
 
+// ⏳ Booking status long-poll: each request parks up to STATUS_WAIT_S on the server,
+// and we stop asking after STATUS_GIVE_UP_MS (the booking still completes server-side)
+const STATUS_WAIT_S = 25;
+const STATUS_GIVE_UP_MS = 2 * 60 * 1000;
+const STATUS_RETRY_MS = 2000;
+const STILL_PROCESSING = "⏳ Still processing... check My Bookings in a minute";
+
+const sleep = (ms) => new Promise(resolve => setTimeout(resolve, ms));
+
+// Long-polls an intent until it settles or we give up; returns the last status seen
+const waitForBooking = async (booking) => {
+    const giveUpAt = Date.now() + STATUS_GIVE_UP_MS;
+    while (booking.intent_id && booking.status === 'PROCESSING' && Date.now() < giveUpAt) {
+        try {
+            const poll = await axios.get(`${API_URL}/bookings/status`, {
+                params: { intent: booking.intent_id, wait: STATUS_WAIT_S },
+                timeout: (STATUS_WAIT_S + 5) * 1000
+            });
+            booking = poll.data;
+        } catch (err) {
+            // Busy (503) or a network blip: back off and ask again
+            if (!err.response || err.response.status === 503) { await sleep(STATUS_RETRY_MS); continue; }
+            break; // 404: this node no longer knows the intent; the booking may still land
+        }
+    }
+    return booking;
+};
+
 const Dashboard = ({ token }) => {
     const [seats, setSeats] = useState([]);
     const [user, setUser] = useState(null);
@@ -85,18 +113,27 @@ const Dashboard = ({ token }) => {
         if (!selectedSeat) return;
 
         setStatus("💸 Sending to Payment Queue...");
+        let res;
         try {
-            await axios.post(`${API_URL}/pay`, {
+            res = await axios.post(`${API_URL}/pay`, {
                 seat_id: selectedSeat.id
             });
-            
-            setStatus("🎉 Payment Processing! Ticket Generating...");
-            setSelectedSeat(null); // Clear selection
-            fetchSeats(); // Refresh grid
         } catch (err) {
             console.error(err);
             setStatus("❌ Payment Failed");
+            return;
         }
+
+        setStatus("🎉 Payment Processing! Ticket Generating...");
+        setSelectedSeat(null); // Clear selection
+        fetchSeats(); // Refresh grid
+
+        // Long-poll the intent: the server answers as soon as the booking commits
+        const booking = await waitForBooking(res.data);
+        if (booking.status === 'CONFIRMED') setStatus(`🎟️ Booked! Booking #${booking.booking_id}`);
+        else if (booking.status === 'FAILED') setStatus("❌ Booking Failed (seat already sold)");
+        else setStatus(STILL_PROCESSING);
+        fetchSeats();
     };
 
     // Helper: Determine Seat Color
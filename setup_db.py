@@ -18,6 +18,7 @@ def setup_database():
 
         # 1. CLEANUP (Drop old tables if they exist to start fresh)
         # Note: We use CASCADE to remove linked tables
+        cur.execute("DROP TABLE IF EXISTS booking_outbox CASCADE;")
         cur.execute("DROP TABLE IF EXISTS booking_seats CASCADE;")
         cur.execute("DROP TABLE IF EXISTS bookings CASCADE;")
         cur.execute("DROP TABLE IF EXISTS screen_seats CASCADE;")
@@ -69,7 +70,8 @@ def setup_database():
                 show_id INT, 
                 status VARCHAR(20), 
                 total_amount DECIMAL(10,2),
-                booking_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+                booking_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                idempotency_key TEXT UNIQUE  -- The BookingEvent's key: a redelivered event can't book twice
             );
         """)
 
@@ -82,6 +84,19 @@ def setup_database():
             );
         """)
         
+        # Transactional outbox: /api/pay writes booking events (binary, codec/BookingEvent.h) here, the relay publishes them to RabbitMQ
+        cur.execute("""
+            CREATE TABLE booking_outbox (
+                id BIGSERIAL PRIMARY KEY,
+                payload BYTEA NOT NULL,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                claimed_until TIMESTAMP  -- Relay lease: publishing happens outside any transaction
+            );
+        """)
+
+        # Keyset pagination for booking history: WHERE user_id = $1 AND id < $cursor ORDER BY id DESC LIMIT n
+        cur.execute("CREATE INDEX idx_bookings_user_id_id ON bookings (user_id, id DESC);")
+        
         # 3. SEED DATA (So the Worker has something to link to)
         print("🌱 Seeding Dummy Data...")
         